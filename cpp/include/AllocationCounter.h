@@ -0,0 +1,24 @@
+#pragma once
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 进程内堆分配计数
+ *
+ * CMake选项 FOOTBALL_COUNT_ALLOCATIONS 打开时替换全局 operator new 统计调用次数（所有线程），
+ * 用于衡量预热后每帧的堆分配次数；关闭时不替换，计数恒为0。
+ */
+class AllocationCounter {
+public:
+    /**
+     * @brief 是否启用了计数
+     */
+    static bool isEnabled();
+    
+    /**
+     * @brief 进程启动以来的堆分配次数
+     */
+    static long long getCount();
+};
+
+} // namespace FootballAnalytics
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include "YOLODetector.h"
+#include "BallTracker.h"
+
+namespace httplib {
+class Client;
+}
 
 namespace FootballAnalytics {
 
+class TaskScheduler;
+
 /**
  * @brief 帧数据结构
  * 
@@ -24,15 +33,63 @@ struct FrameData {
     
     // 分析数据
     std::vector<cv::Point2f> tacMapPositions;  // 战术地图坐标
+    std::vector<cv::Point2f> ballTacMapPositions; // 球的战术地图坐标
     std::vector<int> teamIds;                   // 球队ID
+    BallState ballState;                        // 跟踪平滑后的球状态（检测缺失时为预测值）
+    std::string sceneType;                      // 画面类型（启用画面分类时，非比赛画面不含检测数据）
+    bool reused;                                // 近重复帧，复用上一分析帧的结果（未运行模型）
+    cv::Size inputSize;                         // 本帧检测模型的输入尺寸（未运行检测时为0）
     
-    FrameData() : frameNumber(0), timestamp(0) {}
+    FrameData() : frameNumber(0), timestamp(0), reused(false) {}
+    
+    /**
+     * @brief 清空上一帧的数据（各vector保留容量，对象可跨帧复用）
+     */
+    void clear();
+};
+
+/**
+ * @brief 请求体压缩方式（通过Content-Encoding请求头标明）
+ */
+enum class Compression {
+    None,
+    Gzip,         // 需以 CPPHTTPLIB_ZLIB_SUPPORT 编译
+    Zstd          // 需以 CPPHTTPLIB_ZSTD_SUPPORT 编译
+};
+
+/**
+ * @brief HTTP请求统计
+ */
+struct HttpStats {
+    long long requests = 0;       // 请求数（含失败）
+    long long failures = 0;       // 最终失败的请求数
+    long long connections = 0;    // 建立的TCP连接数
+    long long retries = 0;        // 复用的连接已被服务器关闭、重连后重试的次数
+    long long frameRequests = 0;  // 帧数据请求数（/api/frames 与 /api/frames/batch）
+    long long frames = 0;         // 成功上传的帧数（批量请求按帧计）
+    long long bodyBytes = 0;      // 帧数据请求体的原始字节数
+    long long wireBytes = 0;      // 帧数据请求体实际发送的字节数（压缩后）
+    double totalMs = 0.0;         // 请求耗时之和
+    double maxMs = 0.0;
+    
+    /**
+     * @brief 复用已有连接的请求数
+     */
+    long long reusedRequests() const { return requests > connections ? requests - connections : 0; }
+    
+    double meanMs() const { return requests > 0 ? totalMs / requests : 0.0; }
+    
+    /**
+     * @brief 累加另一个客户端的统计（多个发送连接汇总）
+     */
+    void merge(const HttpStats& other);
 };
 
 /**
  * @brief HTTP API客户端类
  * 
- * 负责将检测结果通过HTTP API发送到服务器
+ * 负责将检测结果通过HTTP API发送到服务器。所有请求共用一个keep-alive连接，
+ * 连接断开时自动重连；请求之间加锁串行，可在多个线程中调用。
  */
 class ApiClient {
 public:
@@ -48,6 +105,11 @@ public:
      */
     ~ApiClient();
     
+    /**
+     * @brief 以相同的服务器地址与设置创建新的客户端（使用独立的连接）
+     */
+    std::unique_ptr<ApiClient> clone() const;
+    
     /**
      * @brief 发送帧数据到服务器
      * @param data 帧数据
@@ -55,6 +117,19 @@ public:
      */
     bool sendFrameData(const FrameData& data);
     
+    /**
+     * @brief 将帧数据序列化为JSON（不访问连接状态，可在多个线程中并行调用）
+     */
+    std::string serializeFrameData(const FrameData& data) const;
+    
+    /**
+     * @brief 发送已序列化的帧数据
+     * @param json serializeFrameData 的结果
+     * @param status 输出HTTP状态码（未收到响应时为0，可据此区分传输错误与服务器拒绝），可为nullptr
+     * @return 成功返回true
+     */
+    bool sendSerializedFrame(const std::string& json, int* status = nullptr);
+    
     /**
      * @brief 批量发送帧数据
      * @param dataList 帧数据列表
@@ -62,6 +137,14 @@ public:
      */
     bool sendBatchFrameData(const std::vector<FrameData>& dataList);
     
+    /**
+     * @brief 以一个请求批量发送已序列化的帧数据（/api/frames/batch）
+     * @param frames serializeFrameData 的结果
+     * @param status 输出HTTP状态码（未收到响应时为0），可为nullptr
+     * @return 成功返回true
+     */
+    bool sendSerializedBatch(const std::vector<std::string>& frames, int* status = nullptr);
+    
     /**
      * @brief 发送视频处理开始通知
      * @param videoSource 视频源标识
@@ -86,36 +169,73 @@ public:
     /**
      * @brief 设置超时时间（秒）
      */
-    void setTimeout(int seconds) { timeoutSeconds_ = seconds; }
+    void setTimeout(int seconds);
     
     /**
      * @brief 启用/禁用调试输出
      */
     void setDebug(bool enable) { debugMode_ = enable; }
 
+    /**
+     * @brief 设置任务调度器（批量发送时并行序列化各帧，不设置时串行）
+     */
+    void setTaskScheduler(TaskScheduler* scheduler) { taskScheduler_ = scheduler; }
+    
+    /**
+     * @brief 设置POST请求体的压缩方式
+     * @return 未编译该压缩支持时返回false（保持不压缩）
+     */
+    bool setCompression(Compression compression);
+    
+    /**
+     * @brief 是否编译了该压缩方式的支持
+     */
+    static bool isCompressionSupported(Compression compression);
+    
+    /**
+     * @brief 获取请求与连接复用统计
+     */
+    HttpStats getHttpStats() const;
+
 private:
     std::string baseUrl_;
     std::string apiKey_;
     int timeoutSeconds_;
     bool debugMode_;
+    TaskScheduler* taskScheduler_;    // 不拥有
+    Compression compression_;
     
     /**
      * @brief 将帧数据转换为JSON字符串
      */
-    std::string frameDataToJson(const FrameData& data);
+    std::string frameDataToJson(const FrameData& data) const;
     
     /**
      * @brief 转义JSON字符串中的特殊字符
      */
-    std::string escapeJsonString(const std::string& str);
+    std::string escapeJsonString(const std::string& str) const;
     
     /**
      * @brief 发送POST请求
      * @param endpoint API端点路径
      * @param jsonData JSON数据
+     * @param frameCount 请求中的帧数（帧数据请求计入字节统计）
+     * @param status 输出HTTP状态码（未收到响应时为0），可为nullptr
      * @return 成功返回true
      */
-    bool sendPostRequest(const std::string& endpoint, const std::string& jsonData);
+    bool sendPostRequest(const std::string& endpoint, const std::string& jsonData, int frameCount = 0,
+                         int* status = nullptr);
+    
+    /**
+     * @brief 按 compression_ 压缩请求体
+     * @return 压缩失败返回false
+     */
+    bool compressBody(const std::string& body, std::string& compressed) const;
+    
+    /**
+     * @brief 获取持久连接的客户端（首次调用或断开后创建，需持有 clientMutex_）
+     */
+    httplib::Client& connection();
     
     /**
      * @brief 提取主机名和端口
@@ -125,6 +245,10 @@ private:
     std::string host_;
     int port_;
     std::string basePath_;
+    
+    std::unique_ptr<httplib::Client> client_;
+    mutable std::mutex clientMutex_;
+    HttpStats httpStats_;
 };
 
 } // namespace FootballAnalytics
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ApiClient.h"
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 发送队列满时的处理策略
+ */
+enum class OverflowPolicy {
+    Block,        // 帧循环等待队列腾出空间（不丢数据，服务器慢时拖慢处理）
+    DropOldest,   // 丢弃队首（最旧）的帧
+    Spill         // 写入磁盘溢出文件，队列有空位时按顺序读回发送
+};
+
+/**
+ * @brief 异步发送参数
+ */
+struct AsyncSendOptions {
+    size_t capacity = 64;                       // 内存队列容量（帧）
+    int workers = 1;                            // 发送线程数（每个线程一个连接，多于1个时帧可能乱序到达）
+    OverflowPolicy overflow = OverflowPolicy::Block;
+    std::string spillPath = "./send_spill.jsonl";
+    int maxRetries = 3;                         // 传输错误或5xx后的最大重试次数（4xx不重试）
+    int retryBaseMs = 100;                      // 首次重试等待时间，之后每次加倍
+    int retryMaxMs = 5000;
+    int batchFrames = 1;                        // 每个请求最多合并的帧数（1为逐帧发送到 /api/frames）
+    int batchWindowMs = 100;                    // 凑批时最早一帧最多等待的时间
+};
+
+/**
+ * @brief 异步发送统计
+ */
+struct AsyncSendStats {
+    long long enqueued = 0;
+    long long requests = 0;         // 发送的请求数（批量发送时一个请求含多帧，不含重试）
+    long long sent = 0;
+    long long failed = 0;           // 放弃的帧数（重试用尽，或服务器返回4xx不重试）
+    long long dropped = 0;          // 队列满时丢弃的帧数（DropOldest）
+    long long spilled = 0;          // 写入溢出文件的帧数
+    long long retries = 0;
+    size_t maxDepth = 0;            // 内存队列的最大深度
+    double blockedMs = 0.0;         // 帧循环等待队列空位的总时间（Block）
+    double sendMs = 0.0;            // 成功的请求耗时之和
+    double maxSendMs = 0.0;
+    double queueMs = 0.0;           // 成功发送的帧从入队到发送完成的耗时之和
+    double maxQueueMs = 0.0;
+};
+
+/**
+ * @brief 有界异步发送队列
+ *
+ * 帧循环只负责入队，后台线程通过 ApiClient 发送；服务器变慢或超时不再阻塞推理。
+ * 失败的请求按指数退避重试。溢出文件启用后新帧一律追加到文件末尾，
+ * 发送线程每取出一帧就从文件读回一帧补入队列，保持先进先出。
+ * 批量发送时发送线程凑满 batchFrames 帧，或最早一帧已等待 batchWindowMs 毫秒后，
+ * 以一个请求发送到 /api/frames/batch；积压时直接取满一批，不再等待。
+ */
+class AsyncSender {
+public:
+    /**
+     * @brief 构造函数（启动发送线程）
+     * @param client 第一个发送线程使用的客户端，其余线程各自建立连接
+     * @param options 发送参数
+     */
+    AsyncSender(ApiClient& client, const AsyncSendOptions& options);
+    
+    /**
+     * @brief 析构函数（不等待未发送的帧，需要时先调用flush）
+     */
+    ~AsyncSender();
+    
+    AsyncSender(const AsyncSender&) = delete;
+    AsyncSender& operator=(const AsyncSender&) = delete;
+    
+    /**
+     * @brief 入队一帧已序列化的数据
+     * @return 传入的帧未被接受（Block策略下等待期间发送器停止）时返回false；
+     *         DropOldest丢弃的是队列中最旧的帧，只计入统计，仍返回true
+     */
+    bool enqueue(std::string json);
+    
+    /**
+     * @brief 等待队列与溢出文件中的帧全部发送完成（或重试用尽）
+     */
+    void flush();
+    
+    /**
+     * @brief 发送完所有排队的帧后通知视频处理完成
+     */
+    bool notifyVideoComplete(const std::string& videoSource);
+    
+    /**
+     * @brief 当前排队的帧数（内存队列与溢出文件）
+     */
+    size_t getDepth() const;
+    
+    /**
+     * @brief 获取统计信息
+     */
+    AsyncSendStats getStats() const;
+    
+    /**
+     * @brief 所有发送连接汇总的HTTP统计（含构造时传入的客户端）
+     */
+    HttpStats getHttpStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    struct Item {
+        std::string json;
+        Clock::time_point enqueued;
+    };
+    
+    ApiClient& client_;
+    AsyncSendOptions options_;
+    std::vector<std::unique_ptr<ApiClient>> extraClients_;   // 第2个起的发送线程的客户端
+    
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::condition_variable idle_;
+    std::condition_variable stopped_;   // 只在析构时通知（重试退避等待用，入队通知不会占用）
+    std::deque<Item> queue_;
+    int inFlight_;              // 已取出、尚未发送完成的帧数
+    int flushWaiters_;          // flush等待中时不再凑批
+    bool stop_;
+    
+    std::fstream spill_;
+    std::streamoff spillReadPos_;
+    size_t spillPending_;
+    
+    AsyncSendStats stats_;
+    std::vector<std::thread> threads_;
+    
+    void workerLoop(ApiClient* client);
+    
+    /**
+     * @brief 按重试策略发送一帧或一批帧
+     * @return 最终是否发送成功
+     */
+    bool sendWithRetry(ApiClient* client, const std::vector<std::string>& frames);
+    
+    /**
+     * @brief 从队首取出一帧并从溢出文件补入一帧（需持有mutex_）
+     */
+    void takeItem(std::vector<Item>& batch);
+    
+    /**
+     * @brief 追加到溢出文件（需持有mutex_）
+     */
+    void spillItem(const Item& item);
+    
+    /**
+     * @brief 从溢出文件读回一帧到队尾（需持有mutex_）
+     */
+    void refillFromSpill();
+};
+
+} // namespace FootballAnalytics
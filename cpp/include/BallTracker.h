@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "YOLODetector.h"
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 平滑后的球状态
+ */
+struct BallState {
+    bool valid = false;              // 是否有有效轨迹
+    bool detected = false;           // 本帧是否有检测与轨迹关联（否则为预测值）
+    cv::Point2f position;            // 图像坐标（平滑后）
+    cv::Point2f velocity;            // 图像速度（像素/帧）
+    float confidence = 0.0f;         // 最近一次关联检测的置信度
+    int missedFrames = 0;            // 连续未检测到的帧数
+    bool hasTacMapPosition = false;
+    cv::Point2f tacMapPosition;      // 战术地图坐标
+};
+
+/**
+ * @brief 球轨迹历史中的一个点
+ */
+struct BallTrackPoint {
+    int frameNumber = 0;
+    bool detected = false;
+    cv::Point2f imagePosition;
+    bool hasTacMapPosition = false;
+    cv::Point2f tacMapPosition;
+};
+
+/**
+ * @brief 球跟踪类
+ *
+ * 匀速模型卡尔曼滤波 + 距离门限关联（对应Python参考实现的ball_track_history）。
+ * 轨迹历史存放在构造时分配的定长环形缓冲区中，逐帧更新不分配内存。
+ */
+class BallTracker {
+public:
+    /**
+     * @brief 构造函数
+     * @param maxMissedFrames 连续多少帧未检测到球后重置轨迹（nbr_frames_no_ball_thresh）
+     * @param gateDistance 检测与预测位置的最大距离（像素，ball_track_dist_thresh）
+     * @param historyCapacity 轨迹历史长度（max_track_length）
+     */
+    explicit BallTracker(int maxMissedFrames = 30,
+                         float gateDistance = 100.0f,
+                         int historyCapacity = 35);
+    
+    /**
+     * @brief 用当前帧的球检测结果更新轨迹
+     * @param ballDetections 当前帧的球检测（可为空，此时只做预测）
+     * @param frameNumber 帧号
+     * @return 平滑后的球状态
+     */
+    const BallState& update(const std::vector<Detection>& ballDetections, int frameNumber);
+    
+    /**
+     * @brief 为最新状态及历史点补充战术地图坐标
+     */
+    void setTacMapPosition(const cv::Point2f& tacMapPosition);
+    
+    /**
+     * @brief 下一帧的预测位置（不修改状态）
+     */
+    cv::Point2f predictPosition() const;
+    
+    /**
+     * @brief 下一帧预测位置的不确定半径（像素，约3倍标准差）
+     */
+    float predictionRadius() const;
+    
+    /**
+     * @brief 生成覆盖下一帧预测位置不确定区域的搜索窗口（原分辨率，用于二次检测）
+     * @param frameSize 图像尺寸
+     * @param window 单个窗口尺寸（通常为检测器输入尺寸）
+     * @param maxRegions 窗口数上限（不确定区域较大时使用多个窗口）
+     * @param regions 输出窗口
+     * @return 窗口数（无有效轨迹或图像不大于窗口时为0）
+     */
+    int searchRegions(const cv::Size& frameSize, const cv::Size& window, int maxRegions,
+                      std::vector<cv::Rect>& regions) const;
+    
+    /**
+     * @brief 清空轨迹（场景切换时使用）
+     */
+    void reset();
+    
+    /**
+     * @brief 当前状态
+     */
+    const BallState& getState() const { return state_; }
+    
+    /**
+     * @brief 轨迹历史点数
+     */
+    int historySize() const { return historyCount_; }
+    
+    /**
+     * @brief 按时间顺序访问历史点（0为最早）
+     */
+    const BallTrackPoint& historyAt(int index) const {
+        return history_[(historyHead_ + index) % static_cast<int>(history_.size())];
+    }
+
+private:
+    int maxMissedFrames_;
+    float gateDistance_;
+    
+    cv::Vec4f mean_;          // [x, y, vx, vy]
+    cv::Matx44f covariance_;
+    BallState state_;
+    
+    std::vector<BallTrackPoint> history_;  // 定长环形缓冲区
+    int historyHead_;                      // 最早的点
+    int historyCount_;
+    
+    /**
+     * @brief 以检测初始化轨迹
+     */
+    void initiate(const Detection& det);
+    
+    /**
+     * @brief 追加一个历史点（已满时覆盖最早的点）
+     */
+    void pushHistory(int frameNumber);
+};
+
+} // namespace FootballAnalytics
@@ -8,6 +8,41 @@
 
 namespace FootballAnalytics {
 
+/**
+ * @brief 单应性矩阵更新统计
+ */
+struct HomographyStats {
+    // 最近一次更新
+    double computeMs = 0.0;          // 本次computeHomography耗时（毫秒）
+    int numCorrespondences = 0;      // 有效的关键点对应数
+    int numInliers = 0;              // 内点数
+    float meanReprojError = 0.0f;    // 内点平均重投影误差（战术地图像素）
+    bool updated = false;            // 本次是否更新了单应性矩阵
+    bool warmStart = false;          // 本次是否由上一矩阵热启动+LM精化得到
+    
+    // 累计统计
+    int totalCalls = 0;              // computeHomography调用次数
+    int warmStartUpdates = 0;        // 热启动更新次数
+    int robustUpdates = 0;           // RANSAC/USAC完整估计次数
+    double totalComputeMs = 0.0;     // 累计耗时（毫秒）
+};
+
+/**
+ * @brief 批量投影缓冲区
+ * 
+ * 由调用方持有并跨帧复用，所有点连续存放：[球员脚部 | 球 | 球员边界框四角]
+ */
+struct ProjectionBuffer {
+    std::vector<cv::Point2f> points;
+    size_t numPlayers = 0;
+    size_t numBalls = 0;
+    size_t numCorners = 0;   // 每个球员4个角点（左上、右上、右下、左下）
+    
+    const cv::Point2f* players() const { return points.data(); }
+    const cv::Point2f* balls() const { return points.data() + numPlayers; }
+    const cv::Point2f* corners() const { return points.data() + numPlayers + numBalls; }
+};
+
 /**
  * @brief 坐标转换类
  * 
@@ -44,6 +79,39 @@ public:
     bool computeHomography(const std::vector<Detection>& keypointDetections,
                           int frameNumber);
     
+    /**
+     * @brief 启用/禁用帧间运动跟踪
+     * 
+     * 启用后，在两次关键点检测之间通过跟踪球场特征点估计帧间单应性，
+     * 并与上一次基于关键点的单应性矩阵组合，避免镜头平移时坐标漂移。
+     * @param enable 是否启用
+     * @param keypointRefreshInterval 关键点模型的周期性刷新间隔（帧）
+     */
+    void setMotionTracking(bool enable, int keypointRefreshInterval = 25);
+    
+    /**
+     * @brief 根据帧间运动传播单应性矩阵
+     * @param frame 当前帧图像（BGR）
+     * @param playerDetections 球员检测结果（用于屏蔽运动目标上的特征点）
+     * @param frameNumber 当前帧号
+     * @return 成功估计帧间运动并更新单应性矩阵返回true
+     */
+    bool updateCameraMotion(const cv::Mat& frame,
+                            const std::vector<Detection>& playerDetections,
+                            int frameNumber);
+    
+    /**
+     * @brief 判断当前帧是否需要运行关键点模型
+     * 
+     * 未启用运动跟踪、单应性无效、检测到漂移或到达刷新间隔时返回true
+     */
+    bool needsKeypointUpdate(int frameNumber) const;
+    
+    /**
+     * @brief 清空单应性矩阵与帧间运动状态（镜头切换时使用），下一次关键点检测重新完整估计
+     */
+    void reset();
+    
     /**
      * @brief 将球员坐标转换到战术地图
      * @param playerDetections 球员检测结果
@@ -59,6 +127,33 @@ public:
      */
     cv::Point2f transformPoint(const cv::Point2f& point);
     
+    /**
+     * @brief 批量投影球员脚部位置、球以及（可选）球员边界框四角
+     * 
+     * 所有点在一次向量化运算中完成投影，结果写入调用方提供的缓冲区
+     * @param playerDetections 球员检测结果
+     * @param ballDetections 球检测结果
+     * @param out 输出缓冲区（容量跨帧复用）
+     * @param includeCorners 是否投影边界框四角
+     */
+    void projectDetections(const std::vector<Detection>& playerDetections,
+                           const std::vector<Detection>& ballDetections,
+                           ProjectionBuffer& out,
+                           bool includeCorners = false) const;
+    
+    /**
+     * @brief 批量投影点（允许src与dst相同）
+     * @param inverse false: 图像 -> 战术地图；true: 战术地图 -> 图像
+     */
+    void projectPoints(const cv::Point2f* src, cv::Point2f* dst, size_t count,
+                       bool inverse = false) const;
+    
+    /**
+     * @brief 将战术地图坐标反投影回图像坐标（用于在画面上绘制）
+     */
+    void projectToFrame(const std::vector<cv::Point2f>& tacMapPoints,
+                        std::vector<cv::Point2f>& framePoints) const;
+    
     /**
      * @brief 获取当前单应性矩阵
      */
@@ -69,36 +164,106 @@ public:
      */
     bool hasValidHomography() const { return !homography_.empty(); }
     
+    /**
+     * @brief 球场在战术地图上的范围（所有关键点的外接矩形）
+     */
+    cv::Rect2f getPitchBounds() const;
+    
     /**
      * @brief 设置类别标签映射
      * @param classLabels 关键点类别标签列表
      */
     void setKeypointClassLabels(const std::vector<std::string>& classLabels);
+    
+    /**
+     * @brief 获取单应性矩阵更新统计（耗时、内点）
+     */
+    const HomographyStats& getHomographyStats() const { return stats_; }
 
 private:
     cv::Mat homography_;                              // 当前单应性矩阵
+    cv::Matx33f homographyF_;                         // 缓存的单精度单应性矩阵
+    cv::Matx33f inverseHomographyF_;                  // 缓存的单精度逆矩阵（战术地图 -> 图像）
     cv::Mat tacticalMap_;                             // 战术地图图像
     
-    std::map<std::string, cv::Point2f> keypointMap_;  // 关键点名称到战术地图坐标的映射
+    // 球场关键点按ID稠密存储（ID为配置文件中的顺序）
+    std::map<std::string, int> pointIdByName_;        // 关键点名称 -> 关键点ID（仅用于解析类别）
+    std::vector<cv::Point2f> mapPoints_;              // 关键点ID -> 战术地图坐标
     std::vector<std::string> keypointLabels_;         // 关键点标签列表
+    std::vector<int> classToPointId_;                 // 检测类别ID -> 关键点ID（-1未映射，-2未解析）
+    
+    std::vector<cv::Point2f> prevKeypointsSrc_;       // 上一关键帧的关键点源坐标（按关键点ID）
+    std::vector<uint8_t> prevKeypointValid_;          // 上一关键帧中该关键点是否存在
+    
+    // 每帧复用的缓冲区
+    std::vector<cv::Point2f> srcPoints_;
+    std::vector<cv::Point2f> dstPoints_;
+    std::vector<int> pointIds_;
+    std::vector<float> pointConf_;                    // 关键点ID -> 本帧最高置信度
+    std::vector<int> pointSlot_;                      // 关键点ID -> 本帧在srcPoints_中的位置
+    std::vector<uchar> inlierMask_;
     
-    std::vector<cv::Point2f> prevKeypointsSrc_;       // 上一帧的关键点源坐标
-    std::vector<std::string> prevKeypointLabels_;     // 上一帧的关键点标签
+    float ransacThreshold_;                           // 重投影误差阈值（战术地图像素）
+    float warmStartInlierRatio_;                      // 热启动所需的最低内点比例
+    HomographyStats stats_;
     
     float displacementTolerance_;                     // 关键点位移容差
     int lastUpdateFrame_;                             // 上次更新单应性矩阵的帧号
     
+    // 帧间运动跟踪
+    bool motionTrackingEnabled_;                      // 是否启用帧间运动跟踪
+    int keypointRefreshInterval_;                     // 关键点模型刷新间隔（帧）
+    int lastKeypointCheckFrame_;                      // 上次使用关键点校验的帧号
+    bool driftDetected_;                              // 帧间跟踪是否失效
+    cv::Mat keypointHomography_;                      // 关键帧图像 -> 战术地图
+    cv::Mat motionToKeyframe_;                        // 当前帧图像 -> 关键帧图像
+    cv::Mat prevGray_;                                // 上一帧缩小后的灰度图
+    std::vector<cv::Point2f> prevFeatures_;           // 上一帧跟踪的特征点（缩小坐标）
+    double trackingScale_;                            // 跟踪图像缩放比例
+    
+    // 运动跟踪的逐帧缓冲区（跨帧复用容量，当前灰度图与 prevGray_ 交替使用）
+    cv::Mat smallFrame_;
+    cv::Mat currGray_;
+    cv::Mat featureMask_;
+    std::vector<cv::Point2f> flowPoints_;
+    std::vector<uchar> flowStatus_;
+    std::vector<float> flowError_;
+    std::vector<cv::Point2f> flowPrevPts_;
+    std::vector<cv::Point2f> flowCurrPts_;
+    std::vector<uchar> flowInliers_;
+    
+    /**
+     * @brief 在缩小的灰度图上检测可跟踪的特征点（避开球员区域）
+     */
+    void detectTrackingFeatures(const std::vector<Detection>& playerDetections);
+    
+    /**
+     * @brief 设置当前单应性矩阵并更新单精度缓存
+     */
+    void setHomography(const cv::Mat& H);
+    
     /**
      * @brief 加载关键点映射配置
      */
     bool loadKeypointMap(const std::string& jsonFile);
     
     /**
-     * @brief 计算关键点位移的RMSE
+     * @brief 将检测类别解析为关键点ID（结果缓存在classToPointId_中）
+     */
+    int resolvePointId(const Detection& det);
+    
+    /**
+     * @brief 以已有矩阵为初值，对内点做Levenberg-Marquardt精化
+     * @param H 输入初值/输出精化结果（3x3, CV_64F）
+     * @return 精化后内点的均方根重投影误差
+     */
+    float refineHomographyLM(cv::Mat& H, const std::vector<uchar>& mask, int maxIterations);
+    
+    /**
+     * @brief 统计重投影误差小于阈值的内点
+     * @return 内点数
      */
-    float computeKeypointDisplacementRMSE(
-        const std::vector<cv::Point2f>& prev,
-        const std::vector<cv::Point2f>& curr);
+    int countInliers(const cv::Mat& H, std::vector<uchar>& mask, float& meanError) const;
 };
 
 } // namespace FootballAnalytics
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 帧内存池统计（所有线程汇总）
+ */
+struct FrameArenaStats {
+    long long releases = 0;       // 整体回收次数（最外层作用域结束）
+    long long heapRefills = 0;    // 预分配缓冲区不足、向堆申请的次数
+    size_t peakBytes = 0;         // 单个作用域内的最大分配量
+    size_t maxCapacity = 0;       // 各线程预分配缓冲区的最大容量
+};
+
+/**
+ * @brief 按帧整体回收的线程局部内存池
+ *
+ * 基于 std::pmr::monotonic_buffer_resource：分配只移动指针，单次释放为空操作，
+ * 最外层 FrameArenaScope 结束时整体回收。每个线程一个实例（local()），无需加锁。
+ * 预分配缓冲区不足时向堆申请，回收时按本次用量扩大缓冲区，预热后不再有堆分配。
+ * 只用于帧内临时数据：从中分配的容器不能存活到最外层作用域结束之后。
+ */
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t initialBytes = 64 * 1024);
+    
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    
+    /**
+     * @brief 本线程的内存池
+     */
+    static FrameArena& local();
+    
+    /**
+     * @brief 获取所有线程汇总的统计信息
+     */
+    static FrameArenaStats getStats();
+    
+    size_t getCapacity() const { return capacity_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    friend class FrameArenaScope;
+    
+    /**
+     * @brief 上游分配器（统计缓冲区不足时的堆申请）
+     */
+    class Upstream : public std::pmr::memory_resource {
+    public:
+        long long refills = 0;
+    
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+    
+    size_t capacity_;
+    std::unique_ptr<char[]> buffer_;
+    Upstream upstream_;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> monotonic_;
+    size_t used_;
+    int depth_;      // 嵌套的作用域层数
+    
+    /**
+     * @brief 整体回收；本次溢出到堆时扩大预分配缓冲区
+     */
+    void release();
+};
+
+/**
+ * @brief 帧内存池作用域
+ *
+ * 嵌套使用时只有最外层作用域结束时回收。从 resource() 分配的容器需在作用域对象之后声明，
+ * 以保证先于回收析构。
+ */
+class FrameArenaScope {
+public:
+    FrameArenaScope();
+    ~FrameArenaScope();
+    
+    FrameArenaScope(const FrameArenaScope&) = delete;
+    FrameArenaScope& operator=(const FrameArenaScope&) = delete;
+    
+    std::pmr::memory_resource* resource() const { return &arena_; }
+
+private:
+    FrameArena& arena_;
+};
+
+} // namespace FootballAnalytics
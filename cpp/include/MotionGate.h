@@ -0,0 +1,69 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 运动门控统计
+ */
+struct MotionGateStats {
+    long long frames = 0;          // 检查的帧数
+    long long reusedFrames = 0;    // 复用上一分析帧结果的帧数
+    float lastDifference = 0.0f;   // 最近一帧与参考帧的平均亮度差
+    double totalMs = 0.0;          // 指纹计算累计耗时（毫秒）
+};
+
+/**
+ * @brief 近重复帧的运动门控
+ *
+ * 将每帧缩小为亮度指纹，与最近一次完整分析的帧比较平均绝对差。
+ * 低于阈值（比赛暂停、镜头静止）时复用上一分析帧的结果，跳过模型推理；
+ * 连续复用达到上限后强制重新分析，避免缓慢变化累积。
+ */
+class MotionGate {
+public:
+    /**
+     * @brief 构造函数
+     * @param threshold 平均亮度差阈值（0~255，0表示关闭）
+     * @param maxReuse 连续复用的最大帧数
+     */
+    explicit MotionGate(float threshold = 0.0f, int maxReuse = 10);
+    
+    /**
+     * @brief 判断当前帧能否复用上一分析帧的结果（每帧调用一次）
+     *
+     * 返回false时当前帧成为新的参考帧，调用方应完整分析该帧
+     * @param frame 当前帧（BGR）
+     */
+    bool shouldReuse(const cv::Mat& frame);
+    
+    /**
+     * @brief 清空参考帧，下一帧必须完整分析（镜头切换时使用）
+     */
+    void reset();
+    
+    /**
+     * @brief 是否启用
+     */
+    bool isEnabled() const { return threshold_ > 0.0f; }
+    
+    /**
+     * @brief 获取统计信息
+     */
+    const MotionGateStats& getStats() const { return stats_; }
+
+private:
+    float threshold_;
+    int maxReuse_;
+    int consecutiveReuse_;
+    bool hasReference_;
+    MotionGateStats stats_;
+    
+    // 跨帧复用的缓冲区
+    cv::Mat small_;
+    cv::Mat fingerprint_;
+    cv::Mat reference_;
+};
+
+} // namespace FootballAnalytics
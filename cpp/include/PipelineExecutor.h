@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "ApiClient.h"
+#include "BoundedQueue.h"
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 在流水线各阶段之间传递的帧
+ *
+ * 对象由执行器的帧池分配并跨帧复用（图像缓冲区与各vector保留容量）。
+ */
+struct PipelineFrame {
+    long long index = 0;                 // 源帧序号（从0开始），用于保序
+    cv::Mat frame;
+    FrameData data;
+    
+    // 检测阶段预取的结果（分析阶段使用，未预取时分析阶段自行检测）
+    std::vector<Detection> detections;
+    std::vector<Detection> keypoints;
+    bool detected = false;
+    bool keypointsDetected = false;
+    double detectMs = 0.0;
+    
+    std::string json;                    // 序列化后的帧数据
+    
+    /**
+     * @brief 清空上一帧的结果（保留容量）
+     */
+    void reset();
+};
+
+/**
+ * @brief 流水线阶段统计
+ */
+struct StageStats {
+    std::string name;
+    int workers = 1;
+    long long frames = 0;
+    double busyMs = 0.0;      // 各工作线程处理耗时之和
+    double waitMs = 0.0;      // 等待输入（上游较慢）或空闲帧（下游背压）的耗时之和
+    
+    /**
+     * @brief 折算到每帧的耗时（单帧处理耗时除以工作线程数，流水线吞吐受该值最大的阶段限制）
+     */
+    double msPerFrame() const { return frames > 0 ? busyMs / frames / workers : 0.0; }
+};
+
+/**
+ * @brief 多阶段流水线执行器
+ *
+ * 源函数在解码线程中逐帧填充帧池中的空闲帧；各阶段拥有独立的工作线程，
+ * 阶段之间通过有界无锁队列连接。单工作线程的阶段按帧序处理（有状态阶段，
+ * 如跟踪、单应性），多工作线程的阶段乱序并行处理；输出函数在调用线程中按帧序执行。
+ * 帧池大小限制了在途帧数，下游较慢时源函数等待空闲帧，形成背压。
+ */
+class PipelineExecutor {
+public:
+    typedef std::function<bool(PipelineFrame&)> SourceFunc;
+    typedef std::function<void(PipelineFrame&, int)> StageFunc;   // 第二个参数为工作线程序号
+    typedef std::function<void(PipelineFrame&)> SinkFunc;
+    
+    /**
+     * @brief 构造函数
+     * @param maxInFlight 帧池大小（同时在流水线中的最大帧数）
+     */
+    explicit PipelineExecutor(int maxInFlight = 16);
+    
+    /**
+     * @brief 追加一个阶段（按添加顺序串联）
+     * @param name 阶段名称（统计输出用）
+     * @param func 处理函数（多工作线程时需线程安全；线程独占的资源如推理会话可按工作线程序号选取）
+     * @param workers 工作线程数（1表示按帧序处理）
+     */
+    void addStage(const std::string& name, const StageFunc& func, int workers = 1);
+    
+    /**
+     * @brief 运行流水线直到源函数返回false且所有帧都已输出
+     * @param source 源函数，填充帧并返回true；没有更多帧时返回false
+     * @param sink 输出函数，在调用线程中按帧序调用
+     */
+    void run(const SourceFunc& source, const SinkFunc& sink);
+    
+    /**
+     * @brief 各阶段统计（依次为source、各阶段、sink）
+     */
+    const std::vector<StageStats>& getStats() const { return stats_; }
+
+private:
+    struct Stage {
+        std::string name;
+        StageFunc func;
+        int workers;
+    };
+    
+    typedef BoundedQueue<PipelineFrame*> FrameQueue;
+    
+    int maxInFlight_;
+    std::vector<Stage> stages_;
+    std::vector<std::unique_ptr<PipelineFrame>> pool_;
+    std::unique_ptr<FrameQueue> freeFrames_;
+    std::vector<std::unique_ptr<FrameQueue>> queues_;   // queues_[i] 为第i阶段的输入，最后一个为sink的输入
+    std::vector<std::unique_ptr<std::atomic<int>>> activeWorkers_;   // 各阶段仍在运行的工作线程数
+    std::vector<StageStats> stats_;
+    std::mutex statsMutex_;
+    
+    void runSource(const SourceFunc& source);
+    void runStage(size_t stageIndex, int worker);
+    
+    /**
+     * @brief 按帧序取出下一帧（单工作线程阶段与sink使用）
+     * @return 输入结束时返回nullptr
+     */
+    PipelineFrame* popOrdered(FrameQueue& queue, std::vector<PipelineFrame*>& pending,
+                              long long& nextIndex, bool& finished, double& waitMs);
+    
+    /**
+     * @brief 出队（队列空时等待）
+     */
+    PipelineFrame* pop(FrameQueue& queue, double& waitMs);
+    
+    /**
+     * @brief 入队（队列满时等待）
+     */
+    void push(FrameQueue& queue, PipelineFrame* item);
+    
+    /**
+     * @brief 向第i个队列发送结束标记（每个消费者一个）
+     */
+    void closeQueue(size_t queueIndex);
+    
+    /**
+     * @brief 累加一个线程的阶段统计
+     */
+    void addStats(size_t statsIndex, long long frames, double busyMs, double waitMs);
+};
+
+} // namespace FootballAnalytics
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "CoordinateTransform.h"
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 球场掩码来源
+ */
+enum class PitchMaskSource {
+    Grass,     // 缩小图像上的草地色调
+    Outline,   // 当前单应性反投影的球场轮廓
+    Auto       // 单应性有效时使用轮廓，否则使用草地色调
+};
+
+/**
+ * @brief 球场掩码统计
+ */
+struct PitchMaskStats {
+    int updates = 0;             // 重新计算次数
+    int outlineUpdates = 0;      // 其中由球场轮廓得到的次数
+    int invalidUpdates = 0;      // 覆盖比例过小（特写、回放等）而不做过滤的次数
+    float coverage = 0.0f;       // 最近一次掩码覆盖比例
+    double totalMs = 0.0;        // 累计耗时（毫秒）
+};
+
+/**
+ * @brief 球场区域掩码
+ *
+ * 在缩小的图像上计算球场区域：草地色调取最大连通域的凸包（包含场内球员），
+ * 或将战术地图上的球场范围经当前单应性反投影到图像。掩码向外扩展一定边距，
+ * 每隔若干帧或单应性由关键点更新后才重新计算。
+ * 用于在检测后处理中提前丢弃看台、替补席、广告牌上的误检，并只对场内球员采样球衣颜色。
+ */
+class PitchMask {
+public:
+    /**
+     * @brief 构造函数
+     * @param maskWidth 掩码宽度（像素，高度按图像比例）
+     * @param refreshInterval 重新计算间隔（帧）
+     * @param margin 向外扩展的边距（相对图像宽度）
+     */
+    explicit PitchMask(int maskWidth = 160, int refreshInterval = 10, float margin = 0.03f);
+    
+    /**
+     * @brief 设置掩码来源
+     */
+    void setSource(PitchMaskSource source) { source_ = source; }
+    
+    /**
+     * @brief 按需更新掩码（到达刷新间隔、图像尺寸变化或单应性由关键点更新时重新计算）
+     * @param frame 当前帧（BGR）
+     * @param frameNumber 帧号
+     * @param coordTransform 坐标转换器（提供单应性与球场范围）
+     * @return 本帧是否重新计算
+     */
+    bool update(const cv::Mat& frame, int frameNumber, const CoordinateTransform& coordTransform);
+    
+    /**
+     * @brief 掩码是否可用于过滤
+     */
+    bool isValid() const { return valid_; }
+    
+    /**
+     * @brief 判断图像坐标点是否在球场内（超出图像的点按最近的边缘判断）
+     */
+    bool contains(const cv::Point2f& point) const;
+    
+    /**
+     * @brief 判断目标的脚底点（边界框底边中点）是否在球场内
+     */
+    bool containsFoot(const cv::Rect& bbox) const {
+        return contains(cv::Point2f(bbox.x + bbox.width * 0.5f, static_cast<float>(bbox.y + bbox.height)));
+    }
+    
+    /**
+     * @brief 掩码对应的原始图像尺寸
+     */
+    const cv::Size& getFrameSize() const { return frameSize_; }
+    
+    /**
+     * @brief 缩小后的掩码（CV_8U，非0为球场）
+     */
+    const cv::Mat& getMask() const { return mask_; }
+    
+    /**
+     * @brief 清空掩码，下一帧重新计算（场景切换时使用）
+     */
+    void reset();
+    
+    /**
+     * @brief 获取统计信息
+     */
+    const PitchMaskStats& getStats() const { return stats_; }
+
+private:
+    int maskWidth_;
+    int refreshInterval_;
+    float margin_;
+    PitchMaskSource source_;
+    
+    bool valid_;
+    int lastUpdateFrame_;
+    int lastHomographyUpdates_;   // 上次计算时单应性的关键点更新次数
+    cv::Size frameSize_;
+    float scaleX_;                // 原图 -> 掩码
+    float scaleY_;
+    cv::Mat mask_;
+    PitchMaskStats stats_;
+    
+    // 跨帧复用的缓冲区
+    cv::Mat small_;
+    cv::Mat hsv_;
+    cv::Mat grass_;
+    cv::Mat pitchTemplate_;       // 战术地图坐标下的球场范围
+    std::vector<std::vector<cv::Point>> contours_;
+    std::vector<cv::Point> hull_;
+    
+    /**
+     * @brief 由草地色调计算掩码
+     * @return 是否找到球场区域
+     */
+    bool computeFromGrass(const cv::Mat& frame);
+    
+    /**
+     * @brief 由单应性反投影的球场轮廓计算掩码
+     * @return 是否成功
+     */
+    bool computeFromOutline(const CoordinateTransform& coordTransform);
+};
+
+} // namespace FootballAnalytics
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "YOLODetector.h"
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 跟踪器统计
+ */
+struct TrackerStats {
+    long long frames = 0;        // 调用update的帧数
+    long long predictedFrames = 0; // 调用predictOnly的帧数
+    long long tracksCreated = 0; // 创建的轨迹总数
+    int activeTracks = 0;        // 当前正在跟踪的轨迹数
+    float meanMotion = 0.0f;     // 跟踪中轨迹的平均帧间位移（相对框高，含镜头运动）
+    double totalMs = 0.0;        // update累计耗时（毫秒）
+    double maxMs = 0.0;          // update单帧最大耗时（毫秒）
+    double predictMs = 0.0;      // predictOnly累计耗时（毫秒）
+};
+
+/**
+ * @brief 预测框与完整检测的对比结果（评估隔帧检测）
+ */
+struct PredictionEval {
+    long long frames = 0;          // 参与对比的预测帧数
+    long long detectedBoxes = 0;   // 完整检测的球员数
+    long long matchedBoxes = 0;    // 有对应预测框的球员数
+    double centerErrorPx = 0.0;    // 中心点误差累计（像素）
+    double iouSum = 0.0;           // IoU累计
+    
+    void accumulate(const std::vector<Detection>& predicted,
+                    const std::vector<Detection>& detected,
+                    float minConfidence);
+};
+
+/**
+ * @brief 匈牙利算法的工作缓冲区（由跟踪器持有，跨帧复用）
+ */
+struct AssignmentWorkspace {
+    std::vector<float> u;              // 行势
+    std::vector<float> v;              // 列势
+    std::vector<float> minv;
+    std::vector<int> p;
+    std::vector<int> way;
+    std::vector<char> used;
+    std::vector<float> transposed;     // 行多于列时转置的代价矩阵
+    std::vector<int> colMatch;
+};
+
+/**
+ * @brief 球员多目标跟踪类
+ *
+ * ByteTrack风格：卡尔曼滤波预测 + IoU代价的匈牙利匹配。
+ * 高分检测先与所有轨迹（含丢失轨迹）匹配，低分检测再与剩余的跟踪中轨迹匹配，
+ * 用于在遮挡、运动模糊时保持轨迹连续。为检测结果赋予跨帧稳定的trackId。
+ */
+class PlayerTracker {
+public:
+    /**
+     * @brief 构造函数
+     * @param highThreshold 高分检测阈值（低于该值的检测只用于延续已有轨迹）
+     * @param lowThreshold 低分检测阈值（低于该值的检测直接丢弃）
+     * @param newTrackThreshold 创建新轨迹所需的最低置信度
+     * @param maxLostFrames 丢失轨迹保留的帧数
+     */
+    explicit PlayerTracker(float highThreshold = 0.6f,
+                           float lowThreshold = 0.1f,
+                           float newTrackThreshold = 0.7f,
+                           int maxLostFrames = 30);
+    
+    /**
+     * @brief 用当前帧的检测结果更新轨迹
+     *
+     * 原地修改检测列表：写入trackId，并移除未能延续任何轨迹的低分检测；
+     * 高分检测始终保留（未创建轨迹时trackId为-1）
+     * @param detections 当前帧的球员检测结果
+     * @param frame 当前帧（BGR，仅光流修正使用，用于下一预测帧）
+     */
+    void update(std::vector<Detection>& detections, const cv::Mat& frame = cv::Mat());
+    
+    /**
+     * @brief 本帧不运行检测，用运动模型预测所有跟踪中轨迹的位置
+     *
+     * 启用光流修正时，在球员框内采样点做金字塔LK光流，以中值位移作为观测修正卡尔曼状态
+     * @param detections 输出预测的球员框（predicted = true）
+     * @param frame 当前帧（BGR，仅光流修正使用）
+     */
+    void predictOnly(std::vector<Detection>& detections, const cv::Mat& frame = cv::Mat());
+    
+    /**
+     * @brief 启用/禁用预测帧的光流修正
+     */
+    void setFlowRefinement(bool enable);
+    
+    /**
+     * @brief 清空所有轨迹（场景切换时使用），轨迹ID继续递增
+     */
+    void reset();
+    
+    /**
+     * @brief 获取统计信息
+     */
+    const TrackerStats& getStats() const { return stats_; }
+
+private:
+    typedef cv::Vec<float, 8> StateVec;    // [cx, cy, a, h, vcx, vcy, va, vh]
+    typedef cv::Matx<float, 8, 8> StateCov;
+    
+    enum class TrackState {
+        New,      // 刚创建，下一帧未匹配即删除
+        Tracked,  // 正常跟踪
+        Lost      // 暂时丢失
+    };
+    
+    /**
+     * @brief 单条轨迹
+     */
+    struct Track {
+        int id;
+        TrackState state;
+        StateVec mean;
+        StateCov covariance;
+        int lastFrame;   // 最后一次匹配的帧
+        float score;     // 最后一次匹配的检测置信度
+        int classId;
+        std::string label;
+    };
+    
+    float highThreshold_;
+    float lowThreshold_;
+    float newTrackThreshold_;
+    int maxLostFrames_;
+    int frameCount_;
+    int nextTrackId_;
+    
+    std::vector<Track> tracks_;
+    TrackerStats stats_;
+    
+    // 预测帧光流修正
+    bool flowRefinement_;
+    double flowScale_;
+    cv::Mat prevGray_;
+    cv::Mat gray_;
+    std::vector<cv::Point2f> flowPrev_;
+    std::vector<cv::Point2f> flowCurr_;
+    std::vector<uchar> flowStatus_;
+    std::vector<float> flowError_;
+    std::vector<int> flowTrack_;       // 每组采样点对应的轨迹下标
+    
+    // 跨帧复用的缓冲区
+    std::vector<int> highDets_;          // 高分检测下标
+    std::vector<int> lowDets_;           // 低分检测下标
+    std::vector<int> poolTracks_;        // 参与匹配的轨迹下标
+    std::vector<cv::Rect2f> trackBoxes_; // 轨迹预测框
+    std::vector<float> cost_;            // 代价矩阵
+    std::vector<int> rowMatch_;          // 匹配结果
+    AssignmentWorkspace assignment_;     // 匈牙利算法缓冲区
+    std::vector<char> trackMatched_;
+    std::vector<char> keep_;
+    
+    /**
+     * @brief 卡尔曼预测
+     */
+    void predict(Track& track) const;
+    
+    /**
+     * @brief 卡尔曼更新
+     */
+    void correct(Track& track, const cv::Rect& bbox) const;
+    
+    /**
+     * @brief 缩小并转换为灰度图（光流修正使用）
+     */
+    void makeFlowImage(const cv::Mat& frame, cv::Mat& gray);
+    
+    /**
+     * @brief 用光流中值位移修正预测帧的轨迹
+     */
+    void refineWithFlow();
+    
+    /**
+     * @brief 更新跟踪数与平均运动统计
+     */
+    void updateMotionStats();
+    
+    /**
+     * @brief 以检测框初始化新轨迹
+     * @param activate 是否直接确认（否则需下一帧再次匹配）
+     */
+    void startTrack(const Detection& det, bool activate);
+    
+    /**
+     * @brief 轨迹状态转换为边界框
+     */
+    static cv::Rect2f stateToBox(const StateVec& mean);
+    
+    /**
+     * @brief 一轮IoU匹配
+     * @param dets 参与匹配的检测下标
+     * @param detections 检测结果
+     * @param maxCost 允许的最大代价（1 - IoU）
+     */
+    void associate(const std::vector<int>& dets,
+                   std::vector<Detection>& detections,
+                   float maxCost);
+};
+
+/**
+ * @brief 隔帧检测调度
+ *
+ * 每N帧运行一次检测器，其余帧使用跟踪器预测。自适应模式下N随场景运动调整：
+ * 球员与镜头运动越快（帧间位移相对框高越大），检测越频繁。
+ */
+class DetectionScheduler {
+public:
+    /**
+     * @brief 构造函数
+     * @param maxInterval 最大检测间隔（帧），1表示每帧检测
+     * @param adaptive 是否根据运动自适应调整间隔
+     */
+    explicit DetectionScheduler(int maxInterval = 1, bool adaptive = true);
+    
+    /**
+     * @brief 判断本帧是否运行检测（每帧调用一次）
+     */
+    bool shouldDetect();
+    
+    /**
+     * @brief 下一帧强制运行检测（无可预测的轨迹等情况）
+     */
+    void requestDetection() { framesSinceDetection_ = -1; }
+    
+    /**
+     * @brief 报告当前场景运动（TrackerStats::meanMotion），更新检测间隔
+     */
+    void reportMotion(float motion);
+    
+    /**
+     * @brief 当前检测间隔
+     */
+    int getInterval() const { return interval_; }
+    
+    long long getDetectedFrames() const { return detectedFrames_; }
+    long long getPredictedFrames() const { return predictedFrames_; }
+
+private:
+    int maxInterval_;
+    bool adaptive_;
+    int interval_;
+    int framesSinceDetection_;
+    float smoothedMotion_;
+    long long detectedFrames_;
+    long long predictedFrames_;
+};
+
+} // namespace FootballAnalytics
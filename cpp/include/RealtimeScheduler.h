@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 实时模式下单帧的处理方式
+ */
+enum class FrameAction {
+    Process,   // 完整处理
+    Degrade,   // 降级处理：跳过关键点、球队预测等可延后的阶段
+    Drop       // 丢弃（不处理也不发送）
+};
+
+/**
+ * @brief 实时调度统计
+ */
+struct RealtimeStats {
+    long long frames = 0;          // 到达的帧数
+    long long processed = 0;       // 完整处理的帧数
+    long long degraded = 0;        // 降级处理的帧数
+    long long dropped = 0;         // 丢弃的帧数
+    long long deadlineMisses = 0;  // 处理完成时已超过截止时间的帧数
+    std::vector<float> latencyMs;  // 每个处理帧的端到端延迟（到达 -> 处理完成）
+    
+    /**
+     * @brief 延迟百分位数（p为0~100）
+     */
+    double latencyPercentile(double p) const;
+};
+
+/**
+ * @brief 截止时间感知的实时调度器
+ *
+ * 第i帧按源帧率在 t0 + i / fps 时刻到达，截止时间为到达后若干个帧周期。
+ * 按源帧率回放文件时，处理快于实时的帧等待到达时刻，模拟直播源；
+ * 处理落后时根据剩余时间与近期完整/降级处理的平滑耗时选择完整处理、降级或丢帧，
+ * 使端到端延迟保持有界，而不是在顺序循环中不断积压。
+ */
+class RealtimeScheduler {
+public:
+    /**
+     * @brief 构造函数
+     * @param fps 源帧率
+     * @param deadlineFrames 截止时间（帧周期数）
+     * @param paceToSource 是否按源帧率等待帧到达（文件回放模拟直播源）
+     */
+    explicit RealtimeScheduler(double fps, double deadlineFrames = 1.5, bool paceToSource = true);
+    
+    /**
+     * @brief 开始计时（第0帧的到达时刻）
+     */
+    void start();
+    
+    /**
+     * @brief 帧到达，决定处理方式（丢弃的帧直接计入统计，不需要调用endFrame）
+     * @param frameIndex 帧序号（从0开始）
+     */
+    FrameAction beginFrame(int frameIndex);
+    
+    /**
+     * @brief 当前帧处理完成（结果已发送），记录延迟与是否超时
+     */
+    void endFrame();
+    
+    /**
+     * @brief 每帧截止时间（毫秒）
+     */
+    double getDeadlineMs() const { return deadlineMs_; }
+    
+    /**
+     * @brief 获取统计信息
+     */
+    const RealtimeStats& getStats() const { return stats_; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    double periodMs_;
+    double deadlineMs_;
+    bool paceToSource_;
+    Clock::time_point startTime_;
+    
+    // 当前帧
+    FrameAction action_;
+    Clock::time_point arrival_;
+    Clock::time_point processStart_;
+    
+    double fullCostMs_;            // 平滑后的完整处理耗时（<0表示未测量）
+    double degradedCostMs_;        // 平滑后的降级处理耗时（<0表示未测量）
+    int consecutiveDrops_;
+    
+    RealtimeStats stats_;
+    
+    double elapsedMs(Clock::time_point from, Clock::time_point to) const {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+};
+
+} // namespace FootballAnalytics
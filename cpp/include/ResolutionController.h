@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 输入分辨率控制统计
+ */
+struct ResolutionStats {
+    std::vector<int> sizes;              // 候选输入边长（升序）
+    std::vector<long long> frames;       // 各边长分析的帧数
+    long long overBudgetFrames = 0;      // 超出延迟预算的帧数
+    int downgrades = 0;
+    int upgrades = 0;
+};
+
+/**
+ * @brief 按延迟预算自适应选择检测模型的输入分辨率
+ *
+ * 分别对各输入边长的检测耗时做指数平滑，未测量过的边长按面积比例由最近的已测边长估计；
+ * 检测以外的耗时（跟踪、关键点、发送等）单独平滑。
+ * 超出预算时立即降一档；预计仍有余量并持续若干帧后才升一档，避免来回切换。
+ */
+class ResolutionController {
+public:
+    /**
+     * @brief 构造函数
+     * @param sizes 候选输入边长（如480/640/960）
+     * @param budgetMs 每帧延迟预算（毫秒）
+     * @param initialSize 初始边长（取最接近的候选值）
+     * @param upgradeFrames 升档前需持续有余量的帧数
+     */
+    ResolutionController(const std::vector<int>& sizes, double budgetMs,
+                         int initialSize = 640, int upgradeFrames = 15);
+    
+    /**
+     * @brief 当前帧使用的输入边长
+     */
+    int currentSize() const { return sizes_[current_]; }
+    
+    /**
+     * @brief 报告本帧各阶段耗时并更新下一帧的分辨率
+     * @param detectMs 本帧检测模型耗时（毫秒，未运行检测时为0）
+     * @param frameMs 本帧总耗时（毫秒）
+     */
+    void report(double detectMs, double frameMs);
+    
+    /**
+     * @brief 获取统计信息
+     */
+    const ResolutionStats& getStats() const { return stats_; }
+
+private:
+    std::vector<int> sizes_;
+    std::vector<double> detectMs_;       // 各边长平滑后的检测耗时（<0表示未测量）
+    double overheadMs_;                  // 平滑后的检测以外耗时（<0表示未测量）
+    double budgetMs_;
+    int upgradeFrames_;
+    int current_;
+    int headroomFrames_;                 // 已连续有余量的帧数
+    ResolutionStats stats_;
+    
+    /**
+     * @brief 估计指定档位的检测耗时
+     */
+    double estimateDetectMs(int index) const;
+};
+
+} // namespace FootballAnalytics
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 画面类型
+ */
+enum class SceneType {
+    Tactical,   // 可用于分析的比赛画面（中远景）
+    CloseUp,    // 球员特写
+    NonPitch    // 观众、替补席、演播室、图形包装等
+};
+
+/**
+ * @brief 单帧分类结果
+ */
+struct SceneInfo {
+    SceneType type = SceneType::Tactical;  // 平滑后的画面类型
+    bool cut = false;                      // 本帧是否为镜头切换
+    float grassRatio = 0.0f;               // 缩略图中草地像素比例
+    float edgeDensity = 0.0f;              // 草地区域内的边缘像素比例
+    float histDistance = 0.0f;             // 与上一帧颜色直方图的Bhattacharyya距离
+    
+    bool isTactical() const { return type == SceneType::Tactical; }
+};
+
+/**
+ * @brief 画面分类统计
+ */
+struct SceneStats {
+    long long frames = 0;
+    long long closeUpFrames = 0;
+    long long nonPitchFrames = 0;
+    long long cuts = 0;
+    double totalMs = 0.0;    // 分类累计耗时（毫秒）
+    
+    long long skippedFrames() const { return closeUpFrames + nonPitchFrames; }
+    double skippedRatio() const { return frames > 0 ? static_cast<double>(skippedFrames()) / frames : 0.0; }
+};
+
+/**
+ * @brief 画面类型分类与镜头切换检测
+ *
+ * 在缩略图上计算草地像素比例与草地区域内的边缘密度：草地很少的为非球场画面，
+ * 草地区域平滑（背景虚化，没有球场线和远处球员）的为特写。
+ * 相邻帧H-S直方图的Bhattacharyya距离超过阈值时判定为镜头切换。
+ * 非切换帧的类型需连续若干帧一致才改变，避免单帧误判造成抖动。
+ */
+class SceneClassifier {
+public:
+    /**
+     * @brief 构造函数
+     * @param minGrassRatio 比赛画面的最低草地比例
+     * @param minEdgeDensity 比赛画面草地区域的最低边缘密度
+     * @param cutThreshold 镜头切换的直方图距离阈值
+     * @param minSceneFrames 非切换帧改变类型所需的连续帧数
+     */
+    explicit SceneClassifier(float minGrassRatio = 0.35f,
+                             float minEdgeDensity = 0.05f,
+                             float cutThreshold = 0.5f,
+                             int minSceneFrames = 3);
+    
+    /**
+     * @brief 分类当前帧（每帧调用一次）
+     * @param frame 当前帧（BGR）
+     * @return 分类结果
+     */
+    const SceneInfo& classify(const cv::Mat& frame);
+    
+    /**
+     * @brief 清空历史（新视频）
+     */
+    void reset();
+    
+    /**
+     * @brief 获取统计信息
+     */
+    const SceneStats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 画面类型名称（API输出使用）
+     */
+    static const char* typeName(SceneType type);
+
+private:
+    float minGrassRatio_;
+    float minEdgeDensity_;
+    float cutThreshold_;
+    int minSceneFrames_;
+    
+    SceneInfo info_;
+    SceneType candidateType_;     // 尚未确认的新类型
+    int candidateFrames_;         // 新类型已连续出现的帧数
+    bool hasPrevious_;
+    SceneStats stats_;
+    
+    // 跨帧复用的缓冲区
+    cv::Mat thumb_;
+    cv::Mat hsv_;
+    cv::Mat grass_;
+    cv::Mat gray_;
+    cv::Mat edges_;
+    cv::Mat hist_;
+    cv::Mat prevHist_;
+    
+    /**
+     * @brief 单帧的原始类型（未平滑）
+     */
+    SceneType rawType() const;
+};
+
+} // namespace FootballAnalytics
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+/**
+ * @brief OpenCV通用SIMD指令的版本兼容封装
+ *
+ * OpenCV 4.9起向量运算改为v_add/v_mul等函数形式（以支持可变长度向量），
+ * 之前的版本只提供运算符重载。这里统一成函数，供各模块的向量化内核使用。
+ */
+
+#if CV_SIMD || CV_SIMD_SCALABLE
+#define FA_SIMD_ENABLED 1
+#else
+#define FA_SIMD_ENABLED 0
+#endif
+
+#if FA_SIMD_ENABLED
+
+namespace FootballAnalytics {
+namespace simd {
+
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+
+inline int lanesF32() { return cv::VTraits<cv::v_float32>::vlanes(); }
+inline cv::v_float32 add(const cv::v_float32& a, const cv::v_float32& b) { return cv::v_add(a, b); }
+inline cv::v_float32 sub(const cv::v_float32& a, const cv::v_float32& b) { return cv::v_sub(a, b); }
+inline cv::v_float32 mul(const cv::v_float32& a, const cv::v_float32& b) { return cv::v_mul(a, b); }
+inline cv::v_float32 div(const cv::v_float32& a, const cv::v_float32& b) { return cv::v_div(a, b); }
+inline cv::v_float32 lt(const cv::v_float32& a, const cv::v_float32& b) { return cv::v_lt(a, b); }
+
+#else
+
+inline int lanesF32() { return cv::v_float32::nlanes; }
+inline cv::v_float32 add(const cv::v_float32& a, const cv::v_float32& b) { return a + b; }
+inline cv::v_float32 sub(const cv::v_float32& a, const cv::v_float32& b) { return a - b; }
+inline cv::v_float32 mul(const cv::v_float32& a, const cv::v_float32& b) { return a * b; }
+inline cv::v_float32 div(const cv::v_float32& a, const cv::v_float32& b) { return a / b; }
+inline cv::v_float32 lt(const cv::v_float32& a, const cv::v_float32& b) { return a < b; }
+
+#endif
+
+} // namespace simd
+} // namespace FootballAnalytics
+
+#endif // FA_SIMD_ENABLED
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace FootballAnalytics {
+
+class TaskGroup;
+
+/**
+ * @brief 任务调度统计
+ */
+struct TaskSchedulerStats {
+    long long tasks = 0;     // 执行的任务数
+    long long stolen = 0;    // 从其他线程队列窃取的任务数
+};
+
+/**
+ * @brief 进程内共享的工作窃取任务调度器
+ *
+ * 每个工作线程有自己的双端队列：本线程提交的任务压入队尾并从队尾取（后进先出，缓存友好），
+ * 空闲线程从其他线程的队首窃取（先进先出，取到的通常是较大的任务）。
+ * 外部线程提交的任务轮流分配到各工作线程。等待任务组完成的线程会参与执行任务，
+ * 因此任务内部可以再嵌套 parallelFor 而不会死锁。
+ * 可将工作线程绑定到指定CPU核心，与推理线程（ONNX Runtime、OpenCV）划分不同的核心集合，避免超额订阅。
+ */
+class TaskScheduler {
+public:
+    /**
+     * @brief 构造函数
+     * @param numThreads 工作线程数（0表示所有任务在调用线程中执行；等待的调用线程也参与执行）
+     * @param cores 工作线程绑定的CPU核心（第i个线程绑定 cores[i % size]，为空时不绑定）
+     */
+    explicit TaskScheduler(int numThreads, const std::vector<int>& cores = std::vector<int>());
+    
+    ~TaskScheduler();
+    
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+    
+    /**
+     * @brief 并行执行区间（与cv::parallel_for_相同的区间划分方式）
+     * @param range 区间
+     * @param body 处理子区间的函数（需线程安全）
+     * @param grain 每个任务的最小元素数
+     */
+    void parallelFor(const cv::Range& range, const std::function<void(const cv::Range&)>& body, int grain = 1);
+    
+    /**
+     * @brief 工作线程数
+     */
+    int getNumThreads() const { return static_cast<int>(workers_.size()); }
+    
+    /**
+     * @brief 获取统计信息
+     */
+    TaskSchedulerStats getStats() const;
+    
+    /**
+     * @brief 将调用线程绑定到指定CPU核心（之后由该线程创建的线程继承该设置）
+     * @return 平台不支持或设置失败时返回false
+     */
+    static bool pinCurrentThread(const std::vector<int>& cores);
+
+private:
+    friend class TaskGroup;
+    
+    struct Task {
+        std::function<void()> func;
+        TaskGroup* group;
+    };
+    
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+    
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<int> queued_;                // 所有队列中的任务数
+    std::atomic<unsigned> nextWorker_;       // 外部提交的轮转位置
+    std::atomic<bool> stop_;
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCond_;
+    std::atomic<long long> tasksRun_;
+    std::atomic<long long> tasksStolen_;
+    
+    void submit(Task task);
+    void workerLoop(int index, int core);
+    
+    /**
+     * @brief 取出并执行一个任务（本线程队尾优先，否则窃取）
+     * @return 没有可执行的任务时返回false
+     */
+    bool runOne(int self);
+    
+    /**
+     * @brief 调用线程在本调度器中的工作线程序号（外部线程为-1）
+     */
+    int currentWorker() const;
+};
+
+/**
+ * @brief 一组可等待的任务
+ *
+ * 没有调度器时任务在 run() 中直接执行。wait() 等待期间参与执行任务，并重新抛出第一个任务异常。
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler* scheduler);
+    ~TaskGroup();
+    
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    
+    /**
+     * @brief 提交任务
+     */
+    void run(std::function<void()> func);
+    
+    /**
+     * @brief 等待所有已提交任务完成
+     */
+    void wait();
+
+private:
+    friend class TaskScheduler;
+    
+    TaskScheduler* scheduler_;
+    std::atomic<int> pending_;
+    std::mutex errorMutex_;
+    std::exception_ptr error_;
+    
+    void execute(const std::function<void()>& func);
+};
+
+} // namespace FootballAnalytics
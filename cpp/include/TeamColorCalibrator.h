@@ -0,0 +1,155 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+#include "YOLODetector.h"
+#include "TeamPredictor.h"
+
+namespace FootballAnalytics {
+
+/**
+ * @brief 球队颜色自动标定类
+ *
+ * 在前N帧中收集所有球员的球衣主颜色，在后台线程中增量聚类为
+ * 两个球队簇和若干离群簇（守门员/裁判），完成后生成两支球队的颜色信息，
+ * 替代手工配置的参考颜色。颜色无法区分守门员属于哪一队，离群颜色只输出到日志，
+ * 两队的守门员参考色使用本队球员颜色。
+ */
+class TeamColorCalibrator {
+public:
+    /**
+     * @brief 构造函数
+     * @param calibrationFrames 参与标定的帧数（只计提供了球员样本的帧）
+     * @param maxFrames 最多查看的帧数（如视频总帧数的一半），到达后用已收集的样本完成标定；
+     *                  不超过calibrationFrames的4倍，0表示取4倍
+     * @param maxPendingFrames 待处理队列上限（队列满时丢弃新帧，不阻塞主循环）
+     */
+    explicit TeamColorCalibrator(int calibrationFrames = 50, int maxFrames = 0, int maxPendingFrames = 8);
+    
+    /**
+     * @brief 析构函数（停止后台线程）
+     */
+    ~TeamColorCalibrator();
+    
+    // 禁止拷贝
+    TeamColorCalibrator(const TeamColorCalibrator&) = delete;
+    TeamColorCalibrator& operator=(const TeamColorCalibrator&) = delete;
+    
+    /**
+     * @brief 提交一帧的球员样本（只拷贝球员小图，立即返回）
+     * @param frame 原始图像（BGR）
+     * @param playerDetections 球员检测结果
+     */
+    void addFrame(const cv::Mat& frame, const std::vector<Detection>& playerDetections);
+    
+    /**
+     * @brief 用已收集的样本立即完成标定（视频结束时调用），阻塞到后台标定结束
+     */
+    void finish();
+    
+    /**
+     * @brief 是否仍在收集样本
+     */
+    bool isCollecting() const { return !lastSubmitted_ && !finished_.load(); }
+    
+    /**
+     * @brief 标定是否完成
+     */
+    bool isReady() const { return ready_.load(); }
+    
+    /**
+     * @brief 后台标定是否已结束（成功或失败）
+     */
+    bool isFinished() const { return finished_.load(); }
+    
+    /**
+     * @brief 获取标定结果
+     * @param team1Name 第一支球队名称
+     * @param team2Name 第二支球队名称
+     * @param team1 输出第一支球队颜色信息
+     * @param team2 输出第二支球队颜色信息
+     * @return 标定成功返回true
+     */
+    bool getTeamColors(const std::string& team1Name, const std::string& team2Name,
+                       TeamColorInfo& team1, TeamColorInfo& team2) const;
+
+private:
+    /**
+     * @brief LAB空间的颜色簇（8位LAB）
+     */
+    struct ColorCluster {
+        cv::Vec3f lab;
+        int count;
+    };
+    
+    /**
+     * @brief 一帧的球员小图
+     */
+    struct FrameSamples {
+        std::vector<cv::Mat> crops;
+        cv::Mat thumbnail;                             // 整帧缩略图（测量草地颜色）
+        bool last;
+    };
+    
+    int calibrationFrames_;
+    int maxFrames_;
+    int maxPendingFrames_;
+    int seenFrames_;                                   // 已查看的帧数（主线程）
+    bool lastSubmitted_;                               // 已提交最后一帧（主线程）
+    
+    std::deque<FrameSamples> pending_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable finishedCv_;
+    bool stop_;
+    std::thread worker_;
+    
+    std::atomic<bool> ready_;
+    std::atomic<bool> finished_;
+    std::vector<ColorCluster> clusters_;              // 仅后台线程访问，完成后只读
+    cv::Scalar teamColors_[2];                         // 球队球员颜色（RGB）
+    cv::Scalar goalkeeperColors_[2];                   // 守门员参考色（RGB，与本队球员颜色相同）
+    
+    TeamPredictor paletteExtractor_;                   // 仅用于提取球衣主颜色
+    cv::Mat hsv_;                                      // 草地测量缓冲区（仅后台线程访问）
+    cv::Mat grass_;
+    
+    /**
+     * @brief 后台线程主循环
+     */
+    void workerLoop();
+    
+    /**
+     * @brief 在缩略图上测量草地颜色（草地色调像素的平均色，8位LAB）
+     * @return 草地像素过少（非比赛画面）时返回false
+     */
+    bool measureGrass(const cv::Mat& thumbnail, cv::Vec3f& grassLab);
+    
+    /**
+     * @brief 标定结束（成功或失败），通知finish()
+     */
+    void markFinished();
+    
+    /**
+     * @brief 将一个样本加入增量聚类
+     */
+    void addSample(const cv::Vec3f& lab);
+    
+    /**
+     * @brief 合并距离过近的簇
+     */
+    void mergeClusters();
+    
+    /**
+     * @brief 根据聚类结果确定两队及离群颜色
+     */
+    bool finalize();
+};
+
+} // namespace FootballAnalytics
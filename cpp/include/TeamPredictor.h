@@ -3,11 +3,15 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <opencv2/opencv.hpp>
 #include "YOLODetector.h"
 
 namespace FootballAnalytics {
 
+class PitchMask;
+class TaskScheduler;
+
 /**
  * @brief 球队颜色信息
  */
@@ -23,6 +27,48 @@ struct TeamColorInfo {
         : teamName(name), playerColor(pColor), goalkeeperColor(gkColor) {}
 };
 
+/**
+ * @brief 调色板提取方式
+ */
+enum class PaletteMode {
+    Histogram,  // 量化颜色直方图取峰值作为初值，在子采样网格上做固定次数迭代（默认）
+    KMeans      // cv::kmeans参考实现（100次迭代，3次尝试）
+};
+
+/**
+ * @brief 调色板提取方式对比结果（直方图 vs K-means）
+ */
+struct PaletteBenchmark {
+    int numCrops = 0;               // 参与对比的球员数
+    int teamAgreements = 0;         // 两种方式预测球队一致的数量
+    double histogramMs = 0.0;       // 直方图方式累计耗时（毫秒）
+    double kmeansMs = 0.0;          // K-means方式累计耗时（毫秒）
+    double dominantLabDistance = 0.0; // 主颜色LAB距离累计值
+    int lutAgreements = 0;          // 查表LAB与cvtColor精确LAB预测球队一致的数量（直方图调色板）
+    double lutLabError = 0.0;       // 主颜色查表LAB与精确LAB的距离累计值
+    
+    void accumulate(const PaletteBenchmark& other) {
+        numCrops += other.numCrops;
+        teamAgreements += other.teamAgreements;
+        histogramMs += other.histogramMs;
+        kmeansMs += other.kmeansMs;
+        dominantLabDistance += other.dominantLabDistance;
+        lutAgreements += other.lutAgreements;
+        lutLabError += other.lutLabError;
+    }
+};
+
+/**
+ * @brief 轨迹球队缓存统计
+ */
+struct TeamCacheStats {
+    long long lookups = 0;   // 带轨迹ID的查询次数
+    long long hits = 0;      // 命中（跳过颜色分析）次数
+    long long offPitch = 0;  // 脚底点在球场外、未做颜色分析的球员数
+    
+    double hitRate() const { return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0; }
+};
+
 /**
  * @brief 球队预测类
  * 
@@ -57,15 +103,44 @@ public:
     std::vector<int> predictTeams(const cv::Mat& frame,
                                   const std::vector<Detection>& playerDetections);
     
+    /**
+     * @brief 预测球员所属球队（写入调用方提供的缓冲区）
+     * @param frame 原始图像（BGR，直接读取ROI，不做整帧转换）
+     * @param playerDetections 球员检测结果
+     * @param teamIds 输出球队ID列表（容量跨帧复用，球场外的球员为-1）
+     */
+    void predictTeams(const cv::Mat& frame,
+                      const std::vector<Detection>& playerDetections,
+                      std::vector<int>& teamIds);
+    
     /**
      * @brief 获取球员的主要颜色调色板
-     * @param frame 原始图像
+     * @param frame 原始图像（BGR）
      * @param bbox 球员边界框
      * @return 主要颜色列表（RGB格式）
      */
     std::vector<cv::Scalar> extractColorPalette(const cv::Mat& frame,
                                                const cv::Rect& bbox);
     
+    /**
+     * @brief 设置调色板提取方式
+     */
+    void setPaletteMode(PaletteMode mode) { paletteMode_ = mode; }
+    
+    /**
+     * @brief 获取调色板提取方式
+     */
+    PaletteMode getPaletteMode() const { return paletteMode_; }
+    
+    /**
+     * @brief 在同一帧上对比直方图与K-means两种调色板提取方式
+     * @param frame 原始图像（BGR）
+     * @param playerDetections 球员检测结果
+     * @return 一致性与耗时统计
+     */
+    PaletteBenchmark benchmarkPaletteModes(const cv::Mat& frame,
+                                           const std::vector<Detection>& playerDetections);
+    
     /**
      * @brief 获取球队数量
      */
@@ -76,20 +151,120 @@ public:
      */
     const std::vector<TeamColorInfo>& getTeamColors() const { return teamColors_; }
 
+    /**
+     * @brief 启用/禁用多球员并行（使用OpenCV共享线程池）
+     */
+    void setParallel(bool enable) { parallel_ = enable; }
+    
+    /**
+     * @brief 多球员并行改用共享任务调度器（nullptr时使用OpenCV线程池）
+     */
+    void setTaskScheduler(TaskScheduler* scheduler) { taskScheduler_ = scheduler; }
+    
+    /**
+     * @brief 设置球场掩码，只对场内球员采样球衣颜色（nullptr关闭）
+     */
+    void setPitchMask(const PitchMask* pitchMask) { pitchMask_ = pitchMask; }
+    
+    /**
+     * @brief 启用按轨迹缓存球队标签
+     * 
+     * 球员的球队不会改变：带轨迹ID（Detection::trackId >= 0）的球员在多帧中累计投票，
+     * 只有新轨迹、低置信度轨迹或到达稀疏刷新间隔时才重新做颜色分析
+     * @param enable 是否启用
+     * @param refreshInterval 稀疏刷新间隔（帧）
+     * @param minConfidence 直接使用缓存所需的最低投票占比
+     */
+    void setTrackCache(bool enable, int refreshInterval = 50, float minConfidence = 0.8f);
+    
+    /**
+     * @brief 获取缓存命中统计
+     */
+    const TeamCacheStats& getCacheStats() const { return cacheStats_; }
+
 private:
+    static constexpr int kMaxPaletteColors = 8;   // 调色板颜色上限
+    static constexpr int kMaxTeams = 8;           // 球队数上限
+    static constexpr int kCacheMinObservations = 3; // 使用缓存前至少观测的次数
+    
+    /**
+     * @brief 单个轨迹的球队累计投票
+     */
+    struct TrackTeamEntry {
+        int votes[kMaxTeams] = {0};
+        int observations = 0;
+        int teamId = -1;
+        int lastComputedFrame = 0;
+        int lastSeenFrame = 0;
+        
+        float confidence() const {
+            return (observations > 0 && teamId >= 0) ? static_cast<float>(votes[teamId]) / observations : 0.0f;
+        }
+    };
+    
     int numPaletteColors_;
+    PaletteMode paletteMode_;
+    bool parallel_;
+    const PitchMask* pitchMask_;              // 球场掩码（不持有）
+    TaskScheduler* taskScheduler_;            // 共享任务调度器（不持有）
     std::vector<TeamColorInfo> teamColors_;
     std::vector<cv::Scalar> referenceColors_; // 所有参考颜色（LAB空间）
     
+    std::vector<float> refL_, refA_, refB_;   // 参考颜色（LAB分量SoA）
+    
+    // 跨帧复用的缓冲区
+    std::vector<int> playerIndices_;                     // 球员在检测列表中的下标
+    std::vector<int> computeSlots_;                      // 需要重新计算的球员（playerIndices_中的位置）
+    std::vector<float> paletteL_, paletteA_, paletteB_;  // 所有球员调色板（LAB分量SoA）
+    std::vector<int> paletteCounts_;                     // 每个球员的有效颜色数
+    std::vector<float> nearestRef_;                      // 每个调色板颜色最近的参考色索引
+    
+    // 轨迹球队缓存
+    bool trackCacheEnabled_;
+    int cacheRefreshInterval_;
+    float cacheMinConfidence_;
+    int frameCounter_;
+    std::unordered_map<int, TrackTeamEntry> trackCache_;
+    TeamCacheStats cacheStats_;
+    
+    /**
+     * @brief 查询轨迹缓存，命中返回true并输出球队ID
+     */
+    bool lookupTrackCache(int trackId, int& teamId);
+    
     /**
-     * @brief RGB转LAB色彩空间
+     * @brief 将本帧的颜色分析结果累计到轨迹缓存，返回累计后的球队ID
+     */
+    int updateTrackCache(int trackId, int observedTeam);
+    
+    /**
+     * @brief 本帧无法提取调色板时的球队ID：轨迹已有缓存时沿用缓存结果，否则返回defaultTeam
+     */
+    int cachedTeamOrDefault(int trackId, int defaultTeam) const;
+    
+    /**
+     * @brief 清理长时间未出现的轨迹
+     */
+    void pruneTrackCache();
+    
+    /**
+     * @brief RGB转LAB色彩空间（预计算查找表）
+     *
+     * 与cv::COLOR_RGB2Lab同为8位LAB尺度，但输入每通道量化为32级（步长8），
+     * 结果与逐像素cvtColor相差平均约2.4、最大约8个单位，决策边界附近的球员可能改判
+     * （--benchmark-palette 输出两者的球队一致率）。
      */
     cv::Scalar rgbToLab(const cv::Scalar& rgb);
     
+    /**
+     * @brief RGB转LAB色彩空间（逐像素cvtColor，不量化，用于对比）
+     */
+    static cv::Scalar rgbToLabExact(const cv::Scalar& rgb);
+    
     /**
      * @brief 计算LAB空间的欧几里得距离
      */
-    float computeLabDistance(const cv::Scalar& lab1, const cv::Scalar& lab2);
+    float computeLabDistance(const cv::Scalar& lab1, const cv::Scalar& lab2) const;
     
     /**
      * @brief 根据颜色距离预测球队
@@ -97,6 +272,36 @@ private:
      * @return 球队ID
      */
     int predictTeamFromPalette(const std::vector<cv::Scalar>& palette);
+    
+    /**
+     * @brief 根据颜色距离预测球队（指定参考色，LAB空间，每支球队2种）
+     */
+    int predictTeamFromPalette(const std::vector<cv::Scalar>& palette,
+                               const std::vector<cv::Scalar>& references) const;
+    
+    /**
+     * @brief 截取球衣区域（球员框中上部），返回ROI视图
+     */
+    cv::Mat jerseyRegion(const cv::Mat& frame, const cv::Rect& bbox) const;
+    
+    /**
+     * @brief 直方图峰值初始化 + 固定迭代的小规模K-means（子采样网格）
+     *
+     * 样本按通道分开存放；bin索引计算与最近中心分配使用向量化内核，
+     * 直方图与簇累加为散列写入，保持标量。
+     * @param region BGR图像的ROI视图
+     * @param palette 输出颜色（RGB顺序，至少kMaxPaletteColors个）
+     * @return 颜色数
+     */
+    int extractPaletteHistogram(const cv::Mat& region, cv::Scalar* palette) const;
+    
+    /**
+     * @brief cv::kmeans参考实现
+     * @param region BGR图像的ROI视图
+     * @param palette 输出颜色（RGB顺序，至少kMaxPaletteColors个）
+     * @return 颜色数
+     */
+    int extractPaletteKMeans(const cv::Mat& region, cv::Scalar* palette) const;
 };
 
 } // namespace FootballAnalytics
@@ -38,7 +38,7 @@ public:
     
     /**
      * @brief 读取下一帧
-     * @param frame 输出的帧数据（OpenCV Mat格式）
+     * @param frame 输出的帧数据（OpenCV Mat格式；已有同尺寸缓冲区时原地覆盖，需保留上一帧时请先clone）
      * @return 成功返回true，失败或到达文件末尾返回false
      */
     bool readFrame(cv::Mat& frame);
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <opencv2/opencv.hpp>
 #include <onnxruntime_cxx_api.h>
 
 namespace FootballAnalytics {
 
+class PitchMask;
+class TaskScheduler;
+
 /**
  * @brief 检测结果结构体
  */
@@ -17,8 +22,23 @@ struct Detection {
     float confidence;       // 置信度
     cv::Point2f center;     // 中心点坐标
     std::string label;      // 类别标签
+    int trackId;            // 跟踪ID（-1表示未跟踪）
+    bool predicted;         // 由跟踪器预测（本帧未运行检测）
     
-    Detection() : classId(-1), confidence(0.0f) {}
+    Detection() : classId(-1), confidence(0.0f), trackId(-1), predicted(false) {}
+};
+
+/**
+ * @brief 分块推理与单次推理的对比统计
+ */
+struct TilingComparison {
+    int frames = 0;
+    long long singleDetections = 0;   // 单次推理检测数
+    long long tiledDetections = 0;    // 分块推理检测数
+    long long singleMatched = 0;      // 单次推理结果中被分块推理覆盖的数量
+    long long tiledOnly = 0;          // 仅分块推理检测到的数量
+    double singleMs = 0.0;            // 单次推理累计耗时（毫秒）
+    double tiledMs = 0.0;             // 分块推理累计耗时（毫秒）
 };
 
 /**
@@ -54,6 +74,66 @@ public:
      */
     std::vector<Detection> detect(const cv::Mat& frame);
     
+    /**
+     * @brief 批量检测多张图像（模型支持动态batch时一次Session::Run）
+     * @param images 输入图像列表
+     * @return 每张图像的检测结果（图像自身坐标）
+     */
+    std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& images);
+    
+    /**
+     * @brief 只在指定区域上检测（各区域原分辨率裁剪后批量推理）
+     * @param frame 原始图像
+     * @param regions 检测区域（原始图像坐标）
+     * @return 合并后的检测结果（原始图像坐标）
+     */
+    std::vector<Detection> detectRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions);
+    
+    /**
+     * @brief 启用分块推理（高分辨率画面中的远处球员）
+     * @param tileSize 分块边长（原图像素，0表示关闭）
+     * @param overlap 相邻分块的重叠比例（0 ~ 0.5）
+     */
+    void setTiling(int tileSize, float overlap = 0.2f);
+    
+    /**
+     * @brief 分块推理：重叠分块一次批量推理，映射回原图后跨分块NMS合并
+     * 
+     * 未启用分块或图像不大于分块时等同于detect()
+     */
+    std::vector<Detection> detectTiled(const cv::Mat& frame);
+    
+    /**
+     * @brief 同时运行单次推理与分块推理并累计对比统计
+     * @return 分块推理结果
+     */
+    std::vector<Detection> compareTiling(const cv::Mat& frame, TilingComparison& stats);
+    
+    /**
+     * @brief 设置球场掩码（nullptr关闭）
+     * 
+     * 掩码有效时，后处理直接丢弃脚底点落在球场外的候选框，不进入NMS。
+     * 只作用于能映射回原图坐标的检测（detect / detectTiled / detectRegions）
+     */
+    void setPitchMask(const PitchMask* pitchMask) { pitchMask_ = pitchMask; }
+    
+    /**
+     * @brief 被球场掩码丢弃的候选框数
+     */
+    long long getMaskRejected() const { return maskRejected_.load(); }
+    
+    /**
+     * @brief 批量/分块推理的各图像后处理与NMS使用共享任务调度器并行（nullptr时顺序执行）
+     */
+    void setTaskScheduler(TaskScheduler* scheduler) { taskScheduler_ = scheduler; }
+    
+    /**
+     * @brief 设置之后创建的检测器的ONNX Runtime算子内线程数（默认4）
+     * 
+     * 推理线程由创建会话的线程启动，继承其CPU亲和性；与任务调度器划分核心时应与推理核心数一致。
+     */
+    static void setIntraOpThreads(int threads) { intraOpThreads_ = threads; }
+    
     /**
      * @brief 设置类别标签
      * @param labels 类别标签列表
@@ -74,6 +154,22 @@ public:
      * @brief 获取输入尺寸
      */
     cv::Size getInputSize() const { return inputSize_; }
+    
+    /**
+     * @brief 设置推理输入尺寸（仅动态尺寸模型，边长对齐到32的倍数）
+     * @return 设置成功返回true；固定尺寸模型且尺寸不同时返回false
+     */
+    bool setInputSize(const cv::Size& size);
+    
+    /**
+     * @brief 模型是否支持动态batch
+     */
+    bool supportsBatch() const { return dynamicBatch_; }
+    
+    /**
+     * @brief 模型是否支持动态输入尺寸
+     */
+    bool supportsDynamicShape() const { return dynamicShape_; }
 
 private:
     std::unique_ptr<Ort::Env> env_;
@@ -86,33 +182,87 @@ private:
     std::vector<std::string> outputNamesStr_;
     
     cv::Size inputSize_;
+    bool dynamicBatch_;
+    bool dynamicShape_;
+    int tileSize_;
+    float tileOverlap_;
     float confThreshold_;
     float iouThreshold_;
     
     std::vector<std::string> classLabels_;
     
+    std::vector<float> inputBuffer_;   // 跨帧复用的输入tensor
+    
+    // 预处理与批量推理的逐帧缓冲区（跨帧复用容量；每个实例只在一个线程中检测）
+    cv::Mat resized_;
+    cv::Mat rgb_;
+    cv::Mat normalized_;
+    std::vector<cv::Mat> channels_;                     // 指向inputBuffer_各通道的Mat头
+    std::vector<cv::Size> imageSizes_;
+    std::vector<std::vector<Detection>> imageResults_;  // detectImages的输出
+    std::vector<cv::Rect> tiles_;
+    std::vector<cv::Mat> crops_;
+    std::vector<cv::Point> cropOffsets_;
+    
+    const PitchMask* pitchMask_;       // 球场掩码（不持有）
+    std::atomic<long long> maskRejected_;   // 各图像的后处理可能并行执行
+    TaskScheduler* taskScheduler_;     // 共享任务调度器（不持有）
+    
+    static int intraOpThreads_;
+    
     /**
-     * @brief 预处理图像
+     * @brief 预处理图像，直接写入NCHW输入缓冲区
      * @param frame 原始图像
-     * @return 预处理后的tensor数据
+     * @param dst 输出位置（3 * H * W个float）
+     */
+    void preprocess(const cv::Mat& frame, float* dst);
+    
+    /**
+     * @brief 批量检测，offsets非空时给出各图像在原图中的位置（用于球场掩码过滤）
+     * @return 每张图像的检测结果（imageResults_，下次检测前有效）
+     */
+    std::vector<std::vector<Detection>>& detectImages(const cv::Mat* images, int count,
+                                                      const cv::Point* offsets);
+    
+    /**
+     * @brief 对inputBuffer_中的batch张图像运行推理并后处理
+     * @param imageSizes 每张图像的原始尺寸
+     * @param batch 图像数
+     * @param offsets 每张图像在原图中的位置（nullptr表示不做掩码过滤）
+     * @param results 输出每张图像NMS后的检测结果（batch个）
      */
-    std::vector<float> preprocess(const cv::Mat& frame);
+    void runBatch(const cv::Size* imageSizes, int batch, const cv::Point* offsets,
+                  std::vector<Detection>* results);
     
     /**
      * @brief 后处理检测结果
-     * @param output 模型输出
+     * @param output 单张图像的模型输出 [4+num_classes, num_anchors]
+     * @param numChannels 输出通道数（4+num_classes）
+     * @param numAnchors 锚点数
      * @param frameSize 原始图像尺寸
-     * @return 检测结果列表
+     * @param maskOffset 图像在原图中的位置（nullptr表示不做掩码过滤）
+     * @param detections 输出的候选框（帧内存池中的临时列表）
      */
-    std::vector<Detection> postprocess(const std::vector<float>& output,
-                                      const cv::Size& frameSize);
+    void postprocess(const float* output, int numChannels, int numAnchors,
+                     const cv::Size& frameSize, const cv::Point* maskOffset,
+                     std::pmr::vector<Detection>& detections);
     
     /**
      * @brief 非极大值抑制（NMS）
-     * @param detections 输入检测结果
+     * @param detections 输入检测结果（原地按置信度排序）
      * @return 过滤后的检测结果
      */
-    std::vector<Detection> nms(const std::vector<Detection>& detections);
+    std::vector<Detection> nms(std::pmr::vector<Detection>& detections);
+    
+    /**
+     * @brief 跨分块合并：IoU超过阈值，或小框大部分落在大框内（分块边缘截断的框）时抑制
+     */
+    std::vector<Detection> mergeTiles(std::pmr::vector<Detection>& detections);
+    
+    /**
+     * @brief 计算分块位置（覆盖整幅图像，最后一块与边缘对齐）
+     */
+    void tileRegions(const cv::Size& frameSize, std::vector<cv::Rect>& tiles) const;
     
     /**
      * @brief 计算两个框的IoU
@@ -6,9 +6,15 @@ Receives detection data and prints logs (no database)
 
 from flask import Flask, request, jsonify
 from datetime import datetime
+import gzip
 import json
 import sys
 
+try:
+    import zstandard
+except ImportError:
+    zstandard = None  # pip install zstandard to accept zstd-compressed bodies
+
 app = Flask(__name__)
 
 # Configuration
@@ -20,9 +26,44 @@ current_session = {
     'video_source': None,
     'total_frames': 0,
     'frames_received': 0,
-    'start_time': None
+    'start_time': None,
+    'frame_requests': 0,   # POSTs to /api/frames and /api/frames/batch
+    'wire_bytes': 0,       # request body bytes as sent (compressed)
+    'body_bytes': 0        # request body bytes after decompression
 }
 
+@app.before_request
+def decode_request_body():
+    """Decompress gzip/zstd request bodies (Content-Encoding) before the routes parse JSON"""
+    if request.method != 'POST':
+        return None
+    
+    encoding = request.headers.get('Content-Encoding', '').lower()
+    raw_data = request.get_data()
+    body = raw_data
+    
+    try:
+        if encoding == 'gzip':
+            body = gzip.decompress(raw_data)
+        elif encoding == 'zstd':
+            if zstandard is None:
+                return jsonify({'status': 'error', 'message': 'zstd not supported (pip install zstandard)'}), 415
+            body = zstandard.ZstdDecompressor().decompressobj().decompress(raw_data)
+        elif encoding not in ('', 'identity'):
+            return jsonify({'status': 'error', 'message': f'Unsupported Content-Encoding: {encoding}'}), 415
+    except Exception as e:
+        print(f"[ERROR] Failed to decode {encoding} body on {request.path}: {e}")
+        return jsonify({'status': 'error', 'message': str(e)}), 400
+    
+    # Routes read the decompressed body through request.data / get_json()
+    request._cached_data = body
+    
+    if request.path.startswith('/api/frames'):
+        current_session['frame_requests'] += 1
+        current_session['wire_bytes'] += len(raw_data)
+        current_session['body_bytes'] += len(body)
+    return None
+
 @app.route('/api/health', methods=['GET'])
 def health_check():
     """Health check endpoint"""
@@ -80,6 +121,9 @@ def video_start():
     current_session['total_frames'] = total_frames
     current_session['frames_received'] = 0
     current_session['start_time'] = datetime.now()
+    current_session['frame_requests'] = 0
+    current_session['wire_bytes'] = 0
+    current_session['body_bytes'] = 0
     
     print("\n" + "=" * 80)
     print(f"VIDEO PROCESSING STARTED")
@@ -202,7 +246,7 @@ def receive_frame():
 def receive_batch_frames():
     """Receive batch frame data"""
     try:
-        data = request.get_json()
+        data = request.get_json(force=True)
         if data is None:
             print(f"[ERROR] No JSON data in /api/frames/batch request")
             return jsonify({'status': 'error', 'message': 'No JSON data provided'}), 400
@@ -214,8 +258,13 @@ def receive_batch_frames():
     
     current_session['frames_received'] += len(frames)
     
-    print(f"[{datetime.now().strftime('%H:%M:%S')}] "
-          f"Received batch: {len(frames)} frames")
+    if VERBOSE_LOGGING:
+        first = frames[0].get('frameNumber', 0) if frames else 0
+        last = frames[-1].get('frameNumber', 0) if frames else 0
+        print(f"[{datetime.now().strftime('%H:%M:%S')}] "
+              f"Received batch: {len(frames)} frames ({first}-{last}), "
+              f"{request.content_length} bytes"
+              f"{' ' + request.headers['Content-Encoding'] if 'Content-Encoding' in request.headers else ''}")
     
     return jsonify({
         'status': 'success',
@@ -227,7 +276,7 @@ def receive_batch_frames():
 def video_complete():
     """Video processing complete notification"""
     try:
-        data = request.get_json()
+        data = request.get_json(force=True)
         if data is None:
             print(f"[ERROR] No JSON data in /api/video/complete request")
             return jsonify({'status': 'error', 'message': 'No JSON data provided'}), 400
@@ -248,6 +297,14 @@ def video_complete():
     print(f"Duration:        {duration:.1f} seconds")
     if duration > 0:
         print(f"Avg FPS:         {current_session['frames_received']/duration:.2f}")
+    frames_received = current_session['frames_received']
+    if frames_received > 0:
+        wire_bytes = current_session['wire_bytes']
+        body_bytes = current_session['body_bytes']
+        print(f"Frame requests:  {current_session['frame_requests']} "
+              f"({frames_received / max(current_session['frame_requests'], 1):.1f} frames/request)")
+        print(f"Bytes received:  {wire_bytes} on the wire, {body_bytes} decoded "
+              f"({wire_bytes / frames_received:.0f} bytes/frame)")
     print(f"Completed at:    {end_time.strftime('%Y-%m-%d %H:%M:%S')}")
     print("=" * 80 + "\n")
     
@@ -256,6 +313,9 @@ def video_complete():
     current_session['total_frames'] = 0
     current_session['frames_received'] = 0
     current_session['start_time'] = None
+    current_session['frame_requests'] = 0
+    current_session['wire_bytes'] = 0
+    current_session['body_bytes'] = 0
     
     return jsonify({
         'status': 'success',
@@ -306,6 +366,7 @@ def main():
     print("    POST /api/video/start        - Start video processing")
     print("    POST /api/frames             - Receive frame data")
     print("    POST /api/frames/batch       - Receive batch frame data")
+    print("    (POST bodies may be gzip/zstd compressed, marked by Content-Encoding)")
     print("    POST /api/video/complete     - Complete video processing")
     print("    POST /api/test               - Test endpoint (prints JSON)")
     
@@ -0,0 +1,47 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<long long> gAllocations(0);
+
+} // namespace
+
+#ifdef FOOTBALL_COUNT_ALLOCATIONS
+
+// 数组、nothrow版本的默认实现均转调以下函数；对齐分配版本不计数
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif
+
+namespace FootballAnalytics {
+
+bool AllocationCounter::isEnabled() {
+#ifdef FOOTBALL_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+long long AllocationCounter::getCount() {
+    return gAllocations.load(std::memory_order_relaxed);
+}
+
+} // namespace FootballAnalytics
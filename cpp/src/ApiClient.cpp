@@ -1,8 +1,11 @@
 #include "ApiClient.h"
+#include "TaskScheduler.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
 
 // 使用cpp-httplib库（header-only）
 // 下载地址：https://github.com/yhirose/cpp-httplib
@@ -10,11 +13,53 @@
 
 namespace FootballAnalytics {
 
+namespace {
+
+/**
+ * @brief 坐标是否为有限值（inf/nan无法表示为JSON数字）
+ */
+bool isFinitePoint(const cv::Point2f& point) {
+    return std::isfinite(point.x) && std::isfinite(point.y);
+}
+
+} // namespace
+
+void FrameData::clear() {
+    frameNumber = 0;
+    timestamp = 0;
+    videoSource.clear();
+    players.clear();
+    keypoints.clear();
+    balls.clear();
+    tacMapPositions.clear();
+    ballTacMapPositions.clear();
+    teamIds.clear();
+    ballState = BallState();
+    sceneType.clear();
+    reused = false;
+    inputSize = cv::Size();
+}
+
+void HttpStats::merge(const HttpStats& other) {
+    requests += other.requests;
+    failures += other.failures;
+    connections += other.connections;
+    retries += other.retries;
+    frameRequests += other.frameRequests;
+    frames += other.frames;
+    bodyBytes += other.bodyBytes;
+    wireBytes += other.wireBytes;
+    totalMs += other.totalMs;
+    maxMs = std::max(maxMs, other.maxMs);
+}
+
 ApiClient::ApiClient(const std::string& baseUrl, const std::string& apiKey)
     : baseUrl_(baseUrl)
     , apiKey_(apiKey)
     , timeoutSeconds_(30)
     , debugMode_(false)
+    , taskScheduler_(nullptr)
+    , compression_(Compression::None)
     , port_(80)
 {
     parseBaseUrl();
@@ -28,6 +73,15 @@ ApiClient::ApiClient(const std::string& baseUrl, const std::string& apiKey)
 ApiClient::~ApiClient() {
 }
 
+std::unique_ptr<ApiClient> ApiClient::clone() const {
+    std::unique_ptr<ApiClient> client(new ApiClient(baseUrl_, apiKey_));
+    client->timeoutSeconds_ = timeoutSeconds_;
+    client->debugMode_ = debugMode_;
+    client->taskScheduler_ = taskScheduler_;
+    client->compression_ = compression_;
+    return client;
+}
+
 void ApiClient::parseBaseUrl() {
     // 解析URL：http://host:port/path
     std::string url = baseUrl_;
@@ -60,7 +114,7 @@ void ApiClient::parseBaseUrl() {
 }
 
 // JSON 字符串转义函数
-std::string ApiClient::escapeJsonString(const std::string& str) {
+std::string ApiClient::escapeJsonString(const std::string& str) const {
     std::ostringstream escaped;
     for (char c : str) {
         switch (c) {
@@ -84,7 +138,7 @@ std::string ApiClient::escapeJsonString(const std::string& str) {
     return escaped.str();
 }
 
-std::string ApiClient::frameDataToJson(const FrameData& data) {
+std::string ApiClient::frameDataToJson(const FrameData& data) const {
     std::ostringstream json;
     
     json << "{";
@@ -92,6 +146,15 @@ std::string ApiClient::frameDataToJson(const FrameData& data) {
     json << "\"timestamp\":" << data.timestamp << ",";
     json << "\"videoSource\":\"" << escapeJsonString(data.videoSource) << "\",";
     
+    if (!data.sceneType.empty()) {
+        json << "\"sceneType\":\"" << escapeJsonString(data.sceneType) << "\",";
+    }
+    json << "\"reused\":" << (data.reused ? "true" : "false") << ",";
+    if (data.inputSize.width > 0) {
+        json << "\"inputSize\":{\"width\":" << data.inputSize.width
+             << ",\"height\":" << data.inputSize.height << "},";
+    }
+    
     // 球员检测
     json << "\"players\":[";
     for (size_t i = 0; i < data.players.size(); i++) {
@@ -108,13 +171,20 @@ std::string ApiClient::frameDataToJson(const FrameData& data) {
         json << "\"confidence\":" << std::fixed << std::setprecision(4) << p.confidence << ",";
         json << "\"label\":\"" << escapeJsonString(p.label) << "\"";
         
+        json << ",\"predicted\":" << (p.predicted ? "true" : "false");
+        
+        // 添加跟踪ID（如果有）
+        if (p.trackId >= 0) {
+            json << ",\"trackId\":" << p.trackId;
+        }
+        
         // 添加球队ID（如果有）
         if (i < data.teamIds.size()) {
             json << ",\"teamId\":" << data.teamIds[i];
         }
         
         // 添加战术地图坐标（如果有）
-        if (i < data.tacMapPositions.size()) {
+        if (i < data.tacMapPositions.size() && isFinitePoint(data.tacMapPositions[i])) {
             json << ",\"tacMapPosition\":{";
             json << "\"x\":" << std::fixed << std::setprecision(2) << data.tacMapPositions[i].x << ",";
             json << "\"y\":" << std::fixed << std::setprecision(2) << data.tacMapPositions[i].y;
@@ -148,71 +218,263 @@ std::string ApiClient::frameDataToJson(const FrameData& data) {
         json << "\"x\":" << std::fixed << std::setprecision(2) << b.center.x << ",";
         json << "\"y\":" << std::fixed << std::setprecision(2) << b.center.y << ",";
         json << "\"confidence\":" << std::fixed << std::setprecision(4) << b.confidence;
+        
+        // 添加战术地图坐标（如果有）
+        if (i < data.ballTacMapPositions.size() && isFinitePoint(data.ballTacMapPositions[i])) {
+            json << ",\"tacMapPosition\":{";
+            json << "\"x\":" << std::fixed << std::setprecision(2) << data.ballTacMapPositions[i].x << ",";
+            json << "\"y\":" << std::fixed << std::setprecision(2) << data.ballTacMapPositions[i].y;
+            json << "}";
+        }
+        
         json << "}";
     }
     json << "]";
     
+    // 跟踪平滑后的球状态
+    if (data.ballState.valid) {
+        const BallState& ball = data.ballState;
+        json << ",\"ball\":{";
+        json << "\"x\":" << std::fixed << std::setprecision(2) << ball.position.x << ",";
+        json << "\"y\":" << std::fixed << std::setprecision(2) << ball.position.y << ",";
+        json << "\"vx\":" << std::fixed << std::setprecision(2) << ball.velocity.x << ",";
+        json << "\"vy\":" << std::fixed << std::setprecision(2) << ball.velocity.y << ",";
+        json << "\"detected\":" << (ball.detected ? "true" : "false") << ",";
+        json << "\"missedFrames\":" << ball.missedFrames;
+        
+        if (ball.hasTacMapPosition && isFinitePoint(ball.tacMapPosition)) {
+            json << ",\"tacMapPosition\":{";
+            json << "\"x\":" << std::fixed << std::setprecision(2) << ball.tacMapPosition.x << ",";
+            json << "\"y\":" << std::fixed << std::setprecision(2) << ball.tacMapPosition.y;
+            json << "}";
+        }
+        
+        json << "}";
+    }
+    
     json << "}";
     
     return json.str();
 }
 
-bool ApiClient::sendPostRequest(const std::string& endpoint, const std::string& jsonData) {
-    try {
-        httplib::Client client(host_, port_);
-        client.set_connection_timeout(timeoutSeconds_, 0);
-        client.set_read_timeout(timeoutSeconds_, 0);
-        client.set_write_timeout(timeoutSeconds_, 0);
-        
-        httplib::Headers headers;
-        headers.emplace("Content-Type", "application/json");
+httplib::Client& ApiClient::connection() {
+    if (!client_) {
+        client_.reset(new httplib::Client(host_, port_));
+        client_->set_keep_alive(true);
+        // 请求头与请求体分开写入，关闭Nagle算法以免keep-alive连接上每个请求等待延迟确认
+        client_->set_tcp_nodelay(true);
+        client_->set_connection_timeout(timeoutSeconds_, 0);
+        client_->set_read_timeout(timeoutSeconds_, 0);
+        client_->set_write_timeout(timeoutSeconds_, 0);
         
-        if (!apiKey_.empty()) {
-            headers.emplace("Authorization", "Bearer " + apiKey_);
+        // 每建立一个TCP连接调用一次，用于统计连接复用
+        client_->set_socket_options([this](socket_t sock) {
+            httplib::default_socket_options(sock);
+            httpStats_.connections++;
+        });
+    }
+    return *client_;
+}
+
+void ApiClient::setTimeout(int seconds) {
+    std::lock_guard<std::mutex> lock(clientMutex_);
+    timeoutSeconds_ = seconds;
+    client_.reset();
+}
+
+bool ApiClient::isCompressionSupported(Compression compression) {
+    switch (compression) {
+        case Compression::None:
+            return true;
+        case Compression::Gzip:
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+            return true;
+#else
+            return false;
+#endif
+        case Compression::Zstd:
+#ifdef CPPHTTPLIB_ZSTD_SUPPORT
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+bool ApiClient::setCompression(Compression compression) {
+    if (!isCompressionSupported(compression)) {
+        std::cerr << "Warning: request compression not compiled in, sending uncompressed bodies" << std::endl;
+        compression_ = Compression::None;
+        return false;
+    }
+    compression_ = compression;
+    return true;
+}
+
+bool ApiClient::compressBody(const std::string& body, std::string& compressed) const {
+    std::unique_ptr<httplib::detail::compressor> compressor;
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+    if (compression_ == Compression::Gzip) {
+        compressor.reset(new httplib::detail::gzip_compressor());
+    }
+#endif
+#ifdef CPPHTTPLIB_ZSTD_SUPPORT
+    if (compression_ == Compression::Zstd) {
+        compressor.reset(new httplib::detail::zstd_compressor());
+    }
+#endif
+    if (!compressor) {
+        return false;
+    }
+    
+    compressed.clear();
+    compressed.reserve(body.size() / 4);
+    return compressor->compress(body.data(), body.size(), true, [&](const char* data, size_t size) {
+        compressed.append(data, size);
+        return true;
+    });
+}
+
+HttpStats ApiClient::getHttpStats() const {
+    std::lock_guard<std::mutex> lock(clientMutex_);
+    return httpStats_;
+}
+
+bool ApiClient::sendPostRequest(const std::string& endpoint, const std::string& jsonData, int frameCount,
+                                int* status) {
+    httplib::Headers headers;
+    headers.emplace("Content-Type", "application/json");
+    
+    if (!apiKey_.empty()) {
+        headers.emplace("Authorization", "Bearer " + apiKey_);
+    }
+    
+    std::string fullPath = basePath_ + endpoint;
+    
+    if (debugMode_) {
+        std::cout << "POST " << host_ << ":" << port_ << fullPath << std::endl;
+        std::cout << "Body: " << jsonData.substr(0, 200) << "..." << std::endl;
+    }
+    
+    // 压缩在加锁之前完成，多个客户端的发送线程可并行压缩
+    std::string compressed;
+    const std::string* body = &jsonData;
+    if (compression_ != Compression::None) {
+        if (compressBody(jsonData, compressed)) {
+            headers.emplace("Content-Encoding", compression_ == Compression::Gzip ? "gzip" : "zstd");
+            body = &compressed;
+        } else {
+            std::cerr << "Warning: request compression failed, sending uncompressed body" << std::endl;
         }
+    }
+    
+    std::lock_guard<std::mutex> lock(clientMutex_);
+    auto startTime = std::chrono::steady_clock::now();
+    bool success = false;
+    if (status != nullptr) {
+        *status = 0;
+    }
+    
+    try {
+        long long connectionsBefore = httpStats_.connections;
+        auto result = connection().Post(fullPath, headers, *body, "application/json");
         
-        std::string fullPath = basePath_ + endpoint;
-        
-        if (debugMode_) {
-            std::cout << "POST " << host_ << ":" << port_ << fullPath << std::endl;
-            std::cout << "Body: " << jsonData.substr(0, 200) << "..." << std::endl;
+        // 复用的连接已被服务器关闭（空闲超时、服务器重启）时重建连接重试一次。
+        // 只在请求未能发出（写失败）或服务器未读请求即关闭连接时重试；读响应失败或超时时
+        // 服务器可能已收到该帧，重试会重复发送并再等待一个超时
+        if (!result && httpStats_.connections == connectionsBefore &&
+            (result.error() == httplib::Error::Write || result.error() == httplib::Error::ConnectionClosed)) {
+            client_.reset();
+            httpStats_.retries++;
+            result = connection().Post(fullPath, headers, *body, "application/json");
         }
         
-        auto result = client.Post(fullPath.c_str(), headers, jsonData, "application/json");
-        
         if (result) {
             if (debugMode_) {
                 std::cout << "Response: " << result->status << std::endl;
             }
-            return result->status >= 200 && result->status < 300;
+            success = result->status >= 200 && result->status < 300;
+            if (status != nullptr) {
+                *status = result->status;
+            }
         } else {
-            std::cerr << "HTTP request failed" << std::endl;
-            return false;
+            std::cerr << "HTTP request failed: " << httplib::to_string(result.error()) << std::endl;
+            client_.reset();
         }
         
     } catch (const std::exception& e) {
         std::cerr << "API request error: " << e.what() << std::endl;
-        return false;
+        client_.reset();
+    }
+    
+    double elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime).count();
+    httpStats_.requests++;
+    httpStats_.totalMs += elapsedMs;
+    httpStats_.maxMs = std::max(httpStats_.maxMs, elapsedMs);
+    if (frameCount > 0) {
+        httpStats_.frameRequests++;
+        httpStats_.bodyBytes += static_cast<long long>(jsonData.size());
+        httpStats_.wireBytes += static_cast<long long>(body->size());
     }
+    if (success) {
+        httpStats_.frames += frameCount;
+    } else {
+        httpStats_.failures++;
+    }
+    return success;
 }
 
 bool ApiClient::sendFrameData(const FrameData& data) {
     std::string jsonData = frameDataToJson(data);
-    return sendPostRequest("/api/frames", jsonData);
+    return sendPostRequest("/api/frames", jsonData, 1);
+}
+
+std::string ApiClient::serializeFrameData(const FrameData& data) const {
+    return frameDataToJson(data);
+}
+
+bool ApiClient::sendSerializedFrame(const std::string& json, int* status) {
+    return sendPostRequest("/api/frames", json, 1, status);
 }
 
 bool ApiClient::sendBatchFrameData(const std::vector<FrameData>& dataList) {
-    std::ostringstream json;
-    json << "{\"frames\":[";
+    // 各帧独立序列化，设置了调度器时并行
+    std::vector<std::string> frames(dataList.size());
+    auto serializeRange = [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; i++) {
+            frames[i] = frameDataToJson(dataList[i]);
+        }
+    };
+    cv::Range all(0, static_cast<int>(dataList.size()));
+    if (taskScheduler_) {
+        taskScheduler_->parallelFor(all, serializeRange);
+    } else {
+        serializeRange(all);
+    }
     
-    for (size_t i = 0; i < dataList.size(); i++) {
-        if (i > 0) json << ",";
-        json << frameDataToJson(dataList[i]);
+    return sendSerializedBatch(frames);
+}
+
+bool ApiClient::sendSerializedBatch(const std::vector<std::string>& frames, int* status) {
+    size_t totalSize = 12;
+    for (const auto& frame : frames) {
+        totalSize += frame.size() + 1;
     }
     
-    json << "]}";
+    std::string json;
+    json.reserve(totalSize);
+    json += "{\"frames\":[";
+    
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (i > 0) json += ",";
+        json += frames[i];
+    }
     
-    return sendPostRequest("/api/frames/batch", json.str());
+    json += "]}";
+    
+    return sendPostRequest("/api/frames/batch", json, static_cast<int>(frames.size()), status);
 }
 
 bool ApiClient::notifyVideoStart(const std::string& videoSource, int totalFrames) {
@@ -239,12 +501,16 @@ bool ApiClient::notifyVideoComplete(const std::string& videoSource) {
 }
 
 bool ApiClient::testConnection() {
+    std::lock_guard<std::mutex> lock(clientMutex_);
     try {
-        httplib::Client client(host_, port_);
+        // 测试请求建立的连接留给之后的请求复用
+        httplib::Client& client = connection();
         client.set_connection_timeout(5, 0);
         
         std::string fullPath = basePath_ + "/api/health";
-        auto result = client.Get(fullPath.c_str());
+        auto result = client.Get(fullPath);
+        client.set_connection_timeout(timeoutSeconds_, 0);
+        httpStats_.requests++;
         
         if (result) {
             std::cout << "API connection test successful (status: " 
@@ -252,11 +518,13 @@ bool ApiClient::testConnection() {
             return result->status >= 200 && result->status < 300;
         } else {
             std::cerr << "API connection test failed" << std::endl;
+            client_.reset();
             return false;
         }
         
     } catch (const std::exception& e) {
         std::cerr << "Connection test error: " << e.what() << std::endl;
+        client_.reset();
         return false;
     }
 }
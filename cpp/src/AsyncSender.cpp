@@ -0,0 +1,277 @@
+#include "AsyncSender.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace FootballAnalytics {
+
+AsyncSender::AsyncSender(ApiClient& client, const AsyncSendOptions& options)
+    : client_(client)
+    , options_(options)
+    , inFlight_(0)
+    , flushWaiters_(0)
+    , stop_(false)
+    , spillReadPos_(0)
+    , spillPending_(0)
+{
+    options_.capacity = std::max<size_t>(options_.capacity, 1);
+    options_.workers = std::max(options_.workers, 1);
+    options_.batchFrames = std::max(options_.batchFrames, 1);
+    
+    if (options_.overflow == OverflowPolicy::Spill) {
+        spill_.open(options_.spillPath, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!spill_.is_open()) {
+            std::cerr << "Warning: cannot open spill file " << options_.spillPath
+                     << ", blocking when the send queue is full" << std::endl;
+            options_.overflow = OverflowPolicy::Block;
+        }
+    }
+    
+    // 每个发送线程一个客户端（ApiClient的请求在同一连接上串行）
+    for (int i = 1; i < options_.workers; i++) {
+        extraClients_.push_back(client_.clone());
+    }
+    threads_.emplace_back(&AsyncSender::workerLoop, this, &client_);
+    for (auto& extra : extraClients_) {
+        threads_.emplace_back(&AsyncSender::workerLoop, this, extra.get());
+    }
+}
+
+AsyncSender::~AsyncSender() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+    idle_.notify_all();
+    stopped_.notify_all();
+    
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    
+    // 溢出文件中仍有未发送的帧时保留文件
+    if (spill_.is_open()) {
+        spill_.close();
+        if (spillPending_ == 0) {
+            std::remove(options_.spillPath.c_str());
+        }
+    }
+}
+
+bool AsyncSender::enqueue(std::string json) {
+    Item item;
+    item.json = std::move(json);
+    item.enqueued = Clock::now();
+    
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stats_.enqueued++;
+        
+        // 已有帧溢出到文件时新帧也写入文件，保持发送顺序
+        if (spillPending_ > 0 || queue_.size() >= options_.capacity) {
+            switch (options_.overflow) {
+                case OverflowPolicy::Block: {
+                    auto waitStart = Clock::now();
+                    notFull_.wait(lock, [this] { return stop_ || queue_.size() < options_.capacity; });
+                    stats_.blockedMs += std::chrono::duration<double, std::milli>(Clock::now() - waitStart).count();
+                    if (stop_) {
+                        stats_.dropped++;
+                        return false;
+                    }
+                    queue_.push_back(std::move(item));
+                    break;
+                }
+                case OverflowPolicy::DropOldest:
+                    // 丢弃的是队首最旧的帧，传入的帧已入队
+                    queue_.pop_front();
+                    stats_.dropped++;
+                    queue_.push_back(std::move(item));
+                    break;
+                case OverflowPolicy::Spill:
+                    spillItem(item);
+                    while (queue_.size() < options_.capacity && spillPending_ > 0) {
+                        refillFromSpill();
+                    }
+                    break;
+            }
+        } else {
+            queue_.push_back(std::move(item));
+        }
+        stats_.maxDepth = std::max(stats_.maxDepth, queue_.size());
+    }
+    
+    notEmpty_.notify_one();
+    return true;
+}
+
+void AsyncSender::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushWaiters_++;
+    notEmpty_.notify_all();
+    idle_.wait(lock, [this] {
+        return stop_ || (queue_.empty() && spillPending_ == 0 && inFlight_ == 0);
+    });
+    flushWaiters_--;
+}
+
+bool AsyncSender::notifyVideoComplete(const std::string& videoSource) {
+    flush();
+    return client_.notifyVideoComplete(videoSource);
+}
+
+size_t AsyncSender::getDepth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + spillPending_;
+}
+
+AsyncSendStats AsyncSender::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+HttpStats AsyncSender::getHttpStats() const {
+    HttpStats stats = client_.getHttpStats();
+    for (const auto& extra : extraClients_) {
+        stats.merge(extra->getHttpStats());
+    }
+    return stats;
+}
+
+void AsyncSender::workerLoop(ApiClient* client) {
+    const size_t batchFrames = static_cast<size_t>(options_.batchFrames);
+    std::vector<Item> batch;
+    std::vector<std::string> frames;
+    
+    for (;;) {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            notEmpty_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            
+            // 凑批窗口从最早一帧入队时算起，积压的帧不再等待
+            auto deadline = queue_.front().enqueued + std::chrono::milliseconds(options_.batchWindowMs);
+            takeItem(batch);
+            while (batch.size() < batchFrames) {
+                if (queue_.empty()) {
+                    bool ready = notEmpty_.wait_until(lock, deadline, [this] {
+                        return stop_ || flushWaiters_ > 0 || !queue_.empty();
+                    });
+                    if (!ready || queue_.empty()) {
+                        break;
+                    }
+                }
+                takeItem(batch);
+            }
+        }
+        notFull_.notify_all();
+        
+        frames.clear();
+        for (auto& item : batch) {
+            frames.push_back(std::move(item.json));
+        }
+        bool success = sendWithRetry(client, frames);
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight_ -= static_cast<int>(batch.size());
+            stats_.requests++;
+            if (success) {
+                auto now = Clock::now();
+                for (const auto& item : batch) {
+                    double queueMs = std::chrono::duration<double, std::milli>(now - item.enqueued).count();
+                    stats_.queueMs += queueMs;
+                    stats_.maxQueueMs = std::max(stats_.maxQueueMs, queueMs);
+                }
+                stats_.sent += static_cast<long long>(batch.size());
+            } else {
+                stats_.failed += static_cast<long long>(batch.size());
+            }
+        }
+        idle_.notify_all();
+    }
+}
+
+void AsyncSender::takeItem(std::vector<Item>& batch) {
+    batch.push_back(std::move(queue_.front()));
+    queue_.pop_front();
+    refillFromSpill();
+    inFlight_++;
+}
+
+bool AsyncSender::sendWithRetry(ApiClient* client, const std::vector<std::string>& frames) {
+    int delayMs = options_.retryBaseMs;
+    
+    for (int attempt = 0; ; attempt++) {
+        auto sendStart = Clock::now();
+        int status = 0;
+        bool success = options_.batchFrames > 1 ? client->sendSerializedBatch(frames, &status)
+                                                : client->sendSerializedFrame(frames.front(), &status);
+        double sendMs = std::chrono::duration<double, std::milli>(Clock::now() - sendStart).count();
+        
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (success) {
+            stats_.sendMs += sendMs;
+            stats_.maxSendMs = std::max(stats_.maxSendMs, sendMs);
+            return true;
+        }
+        // 只重试传输错误（未收到响应）与5xx；4xx（如400、413）重试也不会成功
+        if (attempt >= options_.maxRetries || (status >= 400 && status < 500)) {
+            return false;
+        }
+        
+        // 指数退避；析构时立即放弃
+        stats_.retries++;
+        if (stopped_.wait_for(lock, std::chrono::milliseconds(delayMs), [this] { return stop_; })) {
+            return false;
+        }
+        delayMs = std::min(delayMs * 2, options_.retryMaxMs);
+    }
+}
+
+void AsyncSender::spillItem(const Item& item) {
+    long long enqueuedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        item.enqueued.time_since_epoch()).count();
+    
+    // 每行一帧：入队时刻<TAB>JSON（序列化结果不含换行）
+    spill_.clear();
+    spill_.seekp(0, std::ios::end);
+    spill_ << enqueuedNs << '\t' << item.json << '\n';
+    spillPending_++;
+    stats_.spilled++;
+}
+
+void AsyncSender::refillFromSpill() {
+    if (spillPending_ == 0) {
+        return;
+    }
+    
+    spill_.clear();
+    spill_.seekg(spillReadPos_);
+    long long enqueuedNs = 0;
+    Item item;
+    if (spill_ >> enqueuedNs && spill_.get() == '\t' && std::getline(spill_, item.json)) {
+        spillReadPos_ = spill_.tellg();
+        item.enqueued = Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::nanoseconds(enqueuedNs)));
+        queue_.push_back(std::move(item));
+        spillPending_--;
+    } else {
+        std::cerr << "Warning: failed to read spill file, " << spillPending_ << " frames lost" << std::endl;
+        stats_.failed += static_cast<long long>(spillPending_);
+        spillPending_ = 0;
+    }
+    
+    // 全部读回后清空文件，长时间运行时文件不会无限增长
+    if (spillPending_ == 0) {
+        spill_.close();
+        spill_.open(options_.spillPath, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+        spillReadPos_ = 0;
+    }
+}
+
+} // namespace FootballAnalytics
@@ -0,0 +1,212 @@
+#include "BallTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr float kAccelerationStd = 6.0f;     // 过程噪声：加速度标准差（像素/帧²，射门/传球时变化剧烈）
+constexpr float kMeasurementStd = 2.0f;      // 观测噪声（像素）
+constexpr float kInitVelocityStd = 20.0f;    // 初始化时的速度不确定度（像素/帧）
+constexpr float kGateChi2 = 9.21f;           // 马氏距离门限（2自由度99%）
+constexpr int kReacquireFrames = 3;          // 连续丢失若干帧后允许在门限外重新初始化
+
+} // namespace
+
+BallTracker::BallTracker(int maxMissedFrames, float gateDistance, int historyCapacity)
+    : maxMissedFrames_(maxMissedFrames)
+    , gateDistance_(gateDistance)
+    , mean_(0.0f, 0.0f, 0.0f, 0.0f)
+    , covariance_(cv::Matx44f::eye())
+    , history_(std::max(historyCapacity, 1))
+    , historyHead_(0)
+    , historyCount_(0)
+{
+}
+
+void BallTracker::reset() {
+    state_ = BallState();
+    historyHead_ = 0;
+    historyCount_ = 0;
+}
+
+void BallTracker::initiate(const Detection& det) {
+    mean_ = cv::Vec4f(det.center.x, det.center.y, 0.0f, 0.0f);
+    covariance_ = cv::Matx44f::diag(cv::Vec4f(kMeasurementStd * kMeasurementStd,
+                                              kMeasurementStd * kMeasurementStd,
+                                              kInitVelocityStd * kInitVelocityStd,
+                                              kInitVelocityStd * kInitVelocityStd));
+    state_ = BallState();
+    state_.valid = true;
+    
+    // 与Python参考实现一致：轨迹跳变时清空历史
+    historyHead_ = 0;
+    historyCount_ = 0;
+}
+
+cv::Point2f BallTracker::predictPosition() const {
+    return cv::Point2f(mean_[0] + mean_[2], mean_[1] + mean_[3]);
+}
+
+float BallTracker::predictionRadius() const {
+    if (!state_.valid) {
+        return 0.0f;
+    }
+    
+    // 预测后的位置方差：Pxx + 2Pxv + Pvv + q/4
+    const float q = kAccelerationStd * kAccelerationStd;
+    float varX = covariance_(0, 0) + 2.0f * covariance_(0, 2) + covariance_(2, 2) + 0.25f * q;
+    float varY = covariance_(1, 1) + 2.0f * covariance_(1, 3) + covariance_(3, 3) + 0.25f * q;
+    return 3.0f * std::sqrt(std::max(varX, varY));
+}
+
+int BallTracker::searchRegions(const cv::Size& frameSize, const cv::Size& window, int maxRegions,
+                               std::vector<cv::Rect>& regions) const {
+    regions.clear();
+    if (!state_.valid || (frameSize.width <= window.width && frameSize.height <= window.height)) {
+        return 0;
+    }
+    
+    cv::Size win(std::min(window.width, frameSize.width), std::min(window.height, frameSize.height));
+    cv::Point2f center = predictPosition();
+    float radius = predictionRadius();
+    
+    // 每个方向的窗口数：窗口间保留20%重叠，总数不超过上限
+    int maxPerAxis = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(maxRegions))));
+    int nx = std::min(maxPerAxis, std::max(1, static_cast<int>(std::ceil(2.0f * radius / (0.8f * win.width)))));
+    int ny = std::min(maxPerAxis, std::max(1, static_cast<int>(std::ceil(2.0f * radius / (0.8f * win.height)))));
+    
+    float spanX = std::min(2.0f * radius, 0.8f * win.width * nx);
+    float spanY = std::min(2.0f * radius, 0.8f * win.height * ny);
+    
+    for (int iy = 0; iy < ny; iy++) {
+        for (int ix = 0; ix < nx; ix++) {
+            float cx = center.x + (nx > 1 ? spanX * ((ix + 0.5f) / nx - 0.5f) : 0.0f);
+            float cy = center.y + (ny > 1 ? spanY * ((iy + 0.5f) / ny - 0.5f) : 0.0f);
+            
+            // 平移窗口使其完全落在图像内
+            int x = std::min(std::max(cvRound(cx - win.width * 0.5f), 0), frameSize.width - win.width);
+            int y = std::min(std::max(cvRound(cy - win.height * 0.5f), 0), frameSize.height - win.height);
+            regions.emplace_back(x, y, win.width, win.height);
+        }
+    }
+    
+    return static_cast<int>(regions.size());
+}
+
+const BallState& BallTracker::update(const std::vector<Detection>& ballDetections, int frameNumber) {
+    state_.detected = false;
+    state_.hasTacMapPosition = false;
+    
+    // 1. 预测
+    if (state_.valid) {
+        cv::Matx44f F(1, 0, 1, 0,
+                      0, 1, 0, 1,
+                      0, 0, 1, 0,
+                      0, 0, 0, 1);
+        const float q = kAccelerationStd * kAccelerationStd;
+        cv::Matx44f Q(0.25f * q, 0, 0.5f * q, 0,
+                      0, 0.25f * q, 0, 0.5f * q,
+                      0.5f * q, 0, q, 0,
+                      0, 0.5f * q, 0, q);
+        mean_ = F * mean_;
+        covariance_ = F * covariance_ * F.t() + Q;
+    }
+    
+    // 2. 关联：门限内马氏距离最小的检测
+    const Detection* matched = nullptr;
+    cv::Matx22f S;
+    if (state_.valid) {
+        S = covariance_.get_minor<2, 2>(0, 0);
+        S(0, 0) += kMeasurementStd * kMeasurementStd;
+        S(1, 1) += kMeasurementStd * kMeasurementStd;
+        cv::Matx22f SInv = S.inv();
+        
+        float bestDist = std::numeric_limits<float>::max();
+        for (const auto& det : ballDetections) {
+            cv::Vec2f innovation(det.center.x - mean_[0], det.center.y - mean_[1]);
+            float mahalanobis = innovation.dot(SInv * innovation);
+            float euclidean = std::sqrt(innovation.dot(innovation));
+            if ((euclidean <= gateDistance_ || mahalanobis <= kGateChi2) && mahalanobis < bestDist) {
+                bestDist = mahalanobis;
+                matched = &det;
+            }
+        }
+    }
+    
+    // 3. 无轨迹或轨迹已丢失数帧时，以置信度最高的检测（重新）初始化
+    if (matched == nullptr && !ballDetections.empty() &&
+        (!state_.valid || state_.missedFrames >= kReacquireFrames)) {
+        const Detection* best = &ballDetections[0];
+        for (const auto& det : ballDetections) {
+            if (det.confidence > best->confidence) {
+                best = &det;
+            }
+        }
+        initiate(*best);
+        state_.detected = true;
+        state_.confidence = best->confidence;
+    } else if (matched != nullptr) {
+        // 4. 卡尔曼更新
+        cv::Matx<float, 4, 2> K = covariance_.get_minor<4, 2>(0, 0) * S.inv();
+        cv::Vec2f innovation(matched->center.x - mean_[0], matched->center.y - mean_[1]);
+        mean_ += K * innovation;
+        covariance_ -= K * covariance_.get_minor<2, 4>(0, 0);
+        
+        state_.detected = true;
+        state_.confidence = matched->confidence;
+        state_.missedFrames = 0;
+    } else if (state_.valid) {
+        // 5. 未检测到：仅预测，超过阈值重置
+        if (++state_.missedFrames > maxMissedFrames_) {
+            reset();
+            return state_;
+        }
+    }
+    
+    if (!state_.valid) {
+        return state_;
+    }
+    
+    state_.position = cv::Point2f(mean_[0], mean_[1]);
+    state_.velocity = cv::Point2f(mean_[2], mean_[3]);
+    pushHistory(frameNumber);
+    
+    return state_;
+}
+
+void BallTracker::setTacMapPosition(const cv::Point2f& tacMapPosition) {
+    if (!state_.valid || historyCount_ == 0) {
+        return;
+    }
+    
+    state_.hasTacMapPosition = true;
+    state_.tacMapPosition = tacMapPosition;
+    
+    BallTrackPoint& latest = history_[(historyHead_ + historyCount_ - 1) % static_cast<int>(history_.size())];
+    latest.hasTacMapPosition = true;
+    latest.tacMapPosition = tacMapPosition;
+}
+
+void BallTracker::pushHistory(int frameNumber) {
+    const int capacity = static_cast<int>(history_.size());
+    int slot;
+    if (historyCount_ < capacity) {
+        slot = (historyHead_ + historyCount_) % capacity;
+        historyCount_++;
+    } else {
+        // 已满：覆盖最早的点
+        slot = historyHead_;
+        historyHead_ = (historyHead_ + 1) % capacity;
+    }
+    
+    BallTrackPoint& point = history_[slot];
+    point.frameNumber = frameNumber;
+    point.detected = state_.detected;
+    point.imagePosition = state_.position;
+    point.hasTacMapPosition = false;
+}
+
+} // namespace FootballAnalytics
@@ -1,7 +1,10 @@
 #include "CoordinateTransform.h"
+#include "SimdUtils.h"
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
 
 // 简单的JSON解析（实际项目中应使用nlohmann/json或类似库）
 // 这里提供一个简化版本
@@ -9,8 +12,16 @@ namespace FootballAnalytics {
 
 CoordinateTransform::CoordinateTransform(const std::string& keypointMapFile,
                                          float displacementTolerance)
-    : displacementTolerance_(displacementTolerance)
+    : ransacThreshold_(3.0f)
+    , warmStartInlierRatio_(0.8f)
+    , displacementTolerance_(displacementTolerance)
     , lastUpdateFrame_(-1)
+    , motionTrackingEnabled_(false)
+    , keypointRefreshInterval_(25)
+    , lastKeypointCheckFrame_(-1)
+    , driftDetected_(false)
+    , motionToKeyframe_(cv::Mat::eye(3, 3, CV_64F))
+    , trackingScale_(1.0)
 {
     if (!loadKeypointMap(keypointMapFile)) {
         std::cerr << "Warning: Failed to load keypoint map from " << keypointMapFile << std::endl;
@@ -80,7 +91,13 @@ bool CoordinateTransform::loadKeypointMap(const std::string& jsonFile) {
                     float x = std::stof(coords.substr(0, commaPos));
                     float y = std::stof(coords.substr(commaPos + 1));
                     
-                    keypointMap_[key] = cv::Point2f(x, y);
+                    auto it = pointIdByName_.find(key);
+                    if (it != pointIdByName_.end()) {
+                        mapPoints_[it->second] = cv::Point2f(x, y);
+                    } else {
+                        pointIdByName_[key] = static_cast<int>(mapPoints_.size());
+                        mapPoints_.push_back(cv::Point2f(x, y));
+                    }
                 }
             }
         }
@@ -88,13 +105,64 @@ bool CoordinateTransform::loadKeypointMap(const std::string& jsonFile) {
     
     file.close();
     
-    std::cout << "Keypoint map loaded: " << keypointMap_.size() << " points" << std::endl;
+    std::cout << "Keypoint map loaded: " << mapPoints_.size() << " points" << std::endl;
     
-    return !keypointMap_.empty();
+    // 按关键点ID分配稠密数组
+    size_t numPoints = mapPoints_.size();
+    prevKeypointsSrc_.assign(numPoints, cv::Point2f());
+    prevKeypointValid_.assign(numPoints, 0);
+    pointConf_.assign(numPoints, 0.0f);
+    pointSlot_.assign(numPoints, -1);
+    
+    return !mapPoints_.empty();
+}
+
+cv::Rect2f CoordinateTransform::getPitchBounds() const {
+    if (mapPoints_.empty()) {
+        return cv::Rect2f();
+    }
+    
+    cv::Point2f minPt = mapPoints_[0];
+    cv::Point2f maxPt = mapPoints_[0];
+    for (const auto& pt : mapPoints_) {
+        minPt.x = std::min(minPt.x, pt.x);
+        minPt.y = std::min(minPt.y, pt.y);
+        maxPt.x = std::max(maxPt.x, pt.x);
+        maxPt.y = std::max(maxPt.y, pt.y);
+    }
+    return cv::Rect2f(minPt, maxPt);
 }
 
 void CoordinateTransform::setKeypointClassLabels(const std::vector<std::string>& classLabels) {
     keypointLabels_ = classLabels;
+    
+    // 预先建立类别ID到关键点ID的映射
+    classToPointId_.assign(classLabels.size(), -1);
+    for (size_t c = 0; c < classLabels.size(); c++) {
+        auto it = pointIdByName_.find(classLabels[c]);
+        if (it != pointIdByName_.end()) {
+            classToPointId_[c] = it->second;
+        }
+    }
+}
+
+int CoordinateTransform::resolvePointId(const Detection& det) {
+    if (det.classId < 0) {
+        return -1;
+    }
+    
+    if (det.classId >= static_cast<int>(classToPointId_.size())) {
+        classToPointId_.resize(det.classId + 1, -2);
+    }
+    
+    int& pointId = classToPointId_[det.classId];
+    if (pointId == -2) {
+        // 首次出现的类别：按标签名解析一次并缓存
+        auto it = pointIdByName_.find(det.label);
+        pointId = (it != pointIdByName_.end()) ? it->second : -1;
+    }
+    
+    return pointId;
 }
 
 bool CoordinateTransform::computeHomography(const std::vector<Detection>& keypointDetections,
@@ -104,22 +172,42 @@ bool CoordinateTransform::computeHomography(const std::vector<Detection>& keypoi
         return false;
     }
     
-    // 提取检测到的关键点坐标和标签
-    std::vector<cv::Point2f> srcPoints;
-    std::vector<cv::Point2f> dstPoints;
-    std::vector<std::string> currentLabels;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    // 提取检测到的关键点坐标（同一关键点只保留置信度最高的检测）
+    srcPoints_.clear();
+    dstPoints_.clear();
+    pointIds_.clear();
     
     for (const auto& det : keypointDetections) {
-        // 检查标签是否在映射中
-        auto it = keypointMap_.find(det.label);
-        if (it != keypointMap_.end()) {
-            srcPoints.push_back(det.center);
-            dstPoints.push_back(it->second);
-            currentLabels.push_back(det.label);
+        int pointId = resolvePointId(det);
+        if (pointId < 0) {
+            continue;
+        }
+        
+        int slot = pointSlot_[pointId];
+        if (slot < 0) {
+            pointSlot_[pointId] = static_cast<int>(srcPoints_.size());
+            pointConf_[pointId] = det.confidence;
+            srcPoints_.push_back(det.center);
+            dstPoints_.push_back(mapPoints_[pointId]);
+            pointIds_.push_back(pointId);
+        } else if (det.confidence > pointConf_[pointId]) {
+            pointConf_[pointId] = det.confidence;
+            srcPoints_[slot] = det.center;
         }
     }
     
-    if (srcPoints.size() < 4) {
+    for (int pointId : pointIds_) {
+        pointSlot_[pointId] = -1;
+    }
+    
+    stats_.totalCalls++;
+    stats_.numCorrespondences = static_cast<int>(srcPoints_.size());
+    stats_.updated = false;
+    stats_.warmStart = false;
+    
+    if (srcPoints_.size() < 4) {
         return false;
     }
     
@@ -129,24 +217,31 @@ bool CoordinateTransform::computeHomography(const std::vector<Detection>& keypoi
     if (frameNumber <= 0 || lastUpdateFrame_ < 0) {
         // 第一帧，必须更新
         shouldUpdate = true;
-    } else if (prevKeypointsSrc_.size() >= 4 && currentLabels.size() >= 4) {
-        // 查找共同的关键点
-        std::vector<cv::Point2f> commonPrev;
-        std::vector<cv::Point2f> commonCurr;
-        
-        for (size_t i = 0; i < currentLabels.size(); i++) {
-            for (size_t j = 0; j < prevKeypointLabels_.size(); j++) {
-                if (currentLabels[i] == prevKeypointLabels_[j]) {
-                    commonCurr.push_back(srcPoints[i]);
-                    commonPrev.push_back(prevKeypointsSrc_[j]);
-                    break;
-                }
+    } else {
+        // 上一关键帧的关键点经帧间运动映射到当前帧（未启用跟踪时为单位矩阵）
+        cv::Matx33d keyframeToCurrent = cv::Matx33d(motionToKeyframe_).inv();
+        
+        // 按关键点ID直接查找共同的关键点
+        float sumSquaredError = 0.0f;
+        int numCommon = 0;
+        
+        for (size_t i = 0; i < pointIds_.size(); i++) {
+            int pointId = pointIds_[i];
+            if (!prevKeypointValid_[pointId]) {
+                continue;
             }
+            
+            const cv::Point2f& p = prevKeypointsSrc_[pointId];
+            cv::Vec3d q = keyframeToCurrent * cv::Vec3d(p.x, p.y, 1.0);
+            float dx = srcPoints_[i].x - static_cast<float>(q[0] / q[2]);
+            float dy = srcPoints_[i].y - static_cast<float>(q[1] / q[2]);
+            sumSquaredError += dx * dx + dy * dy;
+            numCommon++;
         }
         
-        if (commonPrev.size() >= 4) {
-            // 计算关键点位移
-            float rmse = computeKeypointDisplacementRMSE(commonPrev, commonCurr);
+        if (numCommon >= 4) {
+            // 计算关键点位移的RMSE（启用跟踪时即传播单应性的漂移量）
+            float rmse = std::sqrt(sumSquaredError / numCommon);
             
             if (rmse > displacementTolerance_) {
                 shouldUpdate = true;
@@ -154,46 +249,465 @@ bool CoordinateTransform::computeHomography(const std::vector<Detection>& keypoi
         } else {
             shouldUpdate = true;
         }
-    } else {
-        shouldUpdate = true;
     }
     
-    if (shouldUpdate) {
-        // 计算单应性矩阵
-        cv::Mat H = cv::findHomography(srcPoints, dstPoints, cv::RANSAC, 3.0);
+    lastKeypointCheckFrame_ = frameNumber;
+    
+    if (!shouldUpdate) {
+        // 关键点与传播结果一致，视为已校验
+        driftDetected_ = false;
+        auto endTime = std::chrono::high_resolution_clock::now();
+        stats_.computeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        stats_.totalComputeMs += stats_.computeMs;
+        return !homography_.empty();
+    }
+    
+    cv::Mat H;
+    float meanError = 0.0f;
+    int numInliers = 0;
+    
+    // 热启动：上一矩阵仍能解释大部分对应点时，只做LM精化
+    if (!homography_.empty()) {
+        cv::Mat warm = homography_.clone();
+        numInliers = countInliers(warm, inlierMask_, meanError);
         
-        if (!H.empty()) {
-            homography_ = H;
-            prevKeypointsSrc_ = srcPoints;
-            prevKeypointLabels_ = currentLabels;
-            lastUpdateFrame_ = frameNumber;
+        if (numInliers >= 4 &&
+            numInliers >= warmStartInlierRatio_ * static_cast<float>(srcPoints_.size())) {
+            meanError = refineHomographyLM(warm, inlierMask_, 10);
+            numInliers = countInliers(warm, inlierMask_, meanError);
             
-            std::cout << "Homography updated at frame " << frameNumber 
-                     << " with " << srcPoints.size() << " keypoints" << std::endl;
-            return true;
+            if (numInliers >= warmStartInlierRatio_ * static_cast<float>(srcPoints_.size())) {
+                H = warm;
+                stats_.warmStart = true;
+            }
         }
     }
     
-    return !homography_.empty();
+    // 热启动失败：完整鲁棒估计
+    if (H.empty()) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 5)
+        const int robustMethod = cv::USAC_MAGSAC;
+#else
+        const int robustMethod = cv::RANSAC;
+#endif
+        H = cv::findHomography(srcPoints_, dstPoints_, robustMethod, ransacThreshold_);
+        if (!H.empty()) {
+            numInliers = countInliers(H, inlierMask_, meanError);
+        }
+    }
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    stats_.computeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    stats_.totalComputeMs += stats_.computeMs;
+    
+    if (H.empty()) {
+        return !homography_.empty();
+    }
+    
+    setHomography(H);
+    keypointHomography_ = H;
+    motionToKeyframe_ = cv::Mat::eye(3, 3, CV_64F);
+    driftDetected_ = false;
+    lastUpdateFrame_ = frameNumber;
+    
+    std::fill(prevKeypointValid_.begin(), prevKeypointValid_.end(), 0);
+    for (size_t i = 0; i < pointIds_.size(); i++) {
+        prevKeypointsSrc_[pointIds_[i]] = srcPoints_[i];
+        prevKeypointValid_[pointIds_[i]] = 1;
+    }
+    
+    stats_.updated = true;
+    stats_.numInliers = numInliers;
+    stats_.meanReprojError = meanError;
+    if (stats_.warmStart) {
+        stats_.warmStartUpdates++;
+    } else {
+        stats_.robustUpdates++;
+    }
+    
+    std::cout << "Homography updated at frame " << frameNumber 
+             << " with " << srcPoints_.size() << " keypoints"
+             << " (" << (stats_.warmStart ? "warm start" : "robust") << ", "
+             << numInliers << " inliers, " << stats_.computeMs << " ms)" << std::endl;
+    return true;
 }
 
-float CoordinateTransform::computeKeypointDisplacementRMSE(
-    const std::vector<cv::Point2f>& prev,
-    const std::vector<cv::Point2f>& curr) {
+int CoordinateTransform::countInliers(const cv::Mat& H, std::vector<uchar>& mask,
+                                      float& meanError) const {
+    cv::Matx33d h(H);
+    mask.assign(srcPoints_.size(), 0);
     
-    if (prev.size() != curr.size() || prev.empty()) {
+    int numInliers = 0;
+    float sumError = 0.0f;
+    
+    for (size_t i = 0; i < srcPoints_.size(); i++) {
+        cv::Vec3d q = h * cv::Vec3d(srcPoints_[i].x, srcPoints_[i].y, 1.0);
+        if (std::abs(q[2]) < 1e-12) {
+            continue;
+        }
+        
+        float dx = static_cast<float>(q[0] / q[2]) - dstPoints_[i].x;
+        float dy = static_cast<float>(q[1] / q[2]) - dstPoints_[i].y;
+        float error = std::sqrt(dx * dx + dy * dy);
+        
+        if (error < ransacThreshold_) {
+            mask[i] = 1;
+            sumError += error;
+            numInliers++;
+        }
+    }
+    
+    meanError = numInliers > 0 ? sumError / numInliers : 0.0f;
+    return numInliers;
+}
+
+float CoordinateTransform::refineHomographyLM(cv::Mat& H, const std::vector<uchar>& mask,
+                                              int maxIterations) {
+    // 8参数（h33 = 1）的Levenberg-Marquardt，点数很少，直接构造法方程
+    cv::Matx33d h0(H);
+    if (std::abs(h0(2, 2)) < 1e-12) {
         return std::numeric_limits<float>::max();
     }
+    h0 *= 1.0 / h0(2, 2);
+    
+    cv::Vec<double, 8> params(h0(0, 0), h0(0, 1), h0(0, 2),
+                              h0(1, 0), h0(1, 1), h0(1, 2),
+                              h0(2, 0), h0(2, 1));
+    
+    // 计算误差平方和，并可选地构造 J^T J 与 J^T r
+    auto evaluate = [&](const cv::Vec<double, 8>& p, cv::Matx<double, 8, 8>* JtJ,
+                        cv::Vec<double, 8>* Jtr) {
+        double sse = 0.0;
+        if (JtJ) {
+            *JtJ = cv::Matx<double, 8, 8>::zeros();
+            *Jtr = cv::Vec<double, 8>::all(0.0);
+        }
+        
+        for (size_t i = 0; i < srcPoints_.size(); i++) {
+            if (!mask[i]) continue;
+            
+            double x = srcPoints_[i].x;
+            double y = srcPoints_[i].y;
+            double w = p[6] * x + p[7] * y + 1.0;
+            if (std::abs(w) < 1e-12) continue;
+            
+            double invW = 1.0 / w;
+            double u = (p[0] * x + p[1] * y + p[2]) * invW;
+            double v = (p[3] * x + p[4] * y + p[5]) * invW;
+            double ru = u - dstPoints_[i].x;
+            double rv = v - dstPoints_[i].y;
+            sse += ru * ru + rv * rv;
+            
+            if (!JtJ) continue;
+            
+            double Ju[8] = {x * invW, y * invW, invW, 0, 0, 0, -u * x * invW, -u * y * invW};
+            double Jv[8] = {0, 0, 0, x * invW, y * invW, invW, -v * x * invW, -v * y * invW};
+            
+            for (int a = 0; a < 8; a++) {
+                (*Jtr)[a] += Ju[a] * ru + Jv[a] * rv;
+                for (int b = a; b < 8; b++) {
+                    (*JtJ)(a, b) += Ju[a] * Ju[b] + Jv[a] * Jv[b];
+                }
+            }
+        }
+        
+        if (JtJ) {
+            for (int a = 0; a < 8; a++) {
+                for (int b = 0; b < a; b++) {
+                    (*JtJ)(a, b) = (*JtJ)(b, a);
+                }
+            }
+        }
+        return sse;
+    };
+    
+    cv::Matx<double, 8, 8> JtJ;
+    cv::Vec<double, 8> Jtr;
+    double sse = evaluate(params, &JtJ, &Jtr);
+    double lambda = 1e-3;
+    
+    for (int iter = 0; iter < maxIterations; iter++) {
+        cv::Matx<double, 8, 8> A = JtJ;
+        for (int a = 0; a < 8; a++) {
+            A(a, a) *= (1.0 + lambda);
+        }
+        
+        cv::Vec<double, 8> delta;
+        if (!cv::solve(A, -Jtr, delta, cv::DECOMP_CHOLESKY)) {
+            break;
+        }
+        
+        cv::Vec<double, 8> candidate = params + delta;
+        double candidateSse = evaluate(candidate, nullptr, nullptr);
+        
+        if (candidateSse < sse) {
+            params = candidate;
+            double improvement = sse - candidateSse;
+            sse = evaluate(params, &JtJ, &Jtr);
+            lambda *= 0.1;
+            if (improvement < 1e-8 * (1.0 + sse)) {
+                break;
+            }
+        } else {
+            lambda *= 10.0;
+        }
+    }
+    
+    H = (cv::Mat_<double>(3, 3) << params[0], params[1], params[2],
+                                   params[3], params[4], params[5],
+                                   params[6], params[7], 1.0);
+    
+    int numInliers = static_cast<int>(std::count(mask.begin(), mask.end(), 1));
+    return numInliers > 0 ? static_cast<float>(std::sqrt(sse / numInliers)) : 0.0f;
+}
+
+void CoordinateTransform::setMotionTracking(bool enable, int keypointRefreshInterval) {
+    motionTrackingEnabled_ = enable;
+    keypointRefreshInterval_ = std::max(1, keypointRefreshInterval);
+    prevGray_.release();
+    prevFeatures_.clear();
+}
+
+void CoordinateTransform::reset() {
+    homography_.release();
+    keypointHomography_.release();
+    motionToKeyframe_ = cv::Mat::eye(3, 3, CV_64F);
+    std::fill(prevKeypointValid_.begin(), prevKeypointValid_.end(), 0);
+    lastUpdateFrame_ = -1;
+    lastKeypointCheckFrame_ = -1;
+    driftDetected_ = false;
+    prevGray_.release();
+    prevFeatures_.clear();
+}
+
+bool CoordinateTransform::needsKeypointUpdate(int frameNumber) const {
+    if (!motionTrackingEnabled_ || homography_.empty() || driftDetected_) {
+        return true;
+    }
+    
+    return lastKeypointCheckFrame_ < 0 ||
+           frameNumber - lastKeypointCheckFrame_ >= keypointRefreshInterval_;
+}
+
+void CoordinateTransform::detectTrackingFeatures(const std::vector<Detection>& playerDetections) {
+    // 屏蔽球员区域：运动目标上的特征点不符合相机运动模型
+    featureMask_.create(prevGray_.size(), CV_8UC1);
+    featureMask_.setTo(cv::Scalar(255));
+    for (const auto& det : playerDetections) {
+        cv::Rect scaled(static_cast<int>(det.bbox.x * trackingScale_),
+                        static_cast<int>(det.bbox.y * trackingScale_),
+                        static_cast<int>(std::ceil(det.bbox.width * trackingScale_)),
+                        static_cast<int>(std::ceil(det.bbox.height * trackingScale_)));
+        cv::rectangle(featureMask_, scaled, cv::Scalar(0), cv::FILLED);
+    }
+    
+    cv::goodFeaturesToTrack(prevGray_, prevFeatures_, 300, 0.01, 8.0, featureMask_);
+}
+
+bool CoordinateTransform::updateCameraMotion(const cv::Mat& frame,
+                                            const std::vector<Detection>& playerDetections,
+                                            int frameNumber) {
+    if (!motionTrackingEnabled_ || frame.empty()) {
+        return false;
+    }
+    
+    // 在缩小的灰度图上跟踪，宽度约640像素
+    const int trackingWidth = 640;
+    trackingScale_ = std::min(1.0, static_cast<double>(trackingWidth) / frame.cols);
+    
+    // 缩放与灰度图写入跨帧复用的缓冲区（不直接引用输入帧，帧缓冲区可能被复用）
+    const cv::Mat* small = &frame;
+    if (trackingScale_ < 1.0) {
+        cv::resize(frame, smallFrame_, cv::Size(), trackingScale_, trackingScale_, cv::INTER_AREA);
+        small = &smallFrame_;
+    }
+    cv::cvtColor(*small, currGray_, cv::COLOR_BGR2GRAY);
+    
+    // 首帧或特征点丢失：仅初始化特征点
+    if (prevGray_.empty() || prevGray_.size() != currGray_.size() || prevFeatures_.size() < 20) {
+        cv::swap(prevGray_, currGray_);
+        detectTrackingFeatures(playerDetections);
+        return false;
+    }
+    
+    std::vector<cv::Point2f>& currFeatures = flowPoints_;
+    cv::calcOpticalFlowPyrLK(prevGray_, currGray_, prevFeatures_, currFeatures, flowStatus_, flowError_,
+                             cv::Size(21, 21), 3);
+    
+    std::vector<cv::Point2f>& prevPts = flowPrevPts_;
+    std::vector<cv::Point2f>& currPts = flowCurrPts_;
+    prevPts.clear();
+    currPts.clear();
+    for (size_t i = 0; i < flowStatus_.size(); i++) {
+        if (flowStatus_[i]) {
+            prevPts.push_back(prevFeatures_[i]);
+            currPts.push_back(currFeatures[i]);
+        }
+    }
+    
+    bool updated = false;
+    
+    if (currPts.size() >= 12) {
+        // 帧间单应性：当前帧 -> 上一帧（缩小坐标）
+        std::vector<uchar>& inlierMask = flowInliers_;
+        cv::Mat Hsmall = cv::findHomography(currPts, prevPts, cv::RANSAC, 1.0, inlierMask);
+        
+        int numInliers = cv::countNonZero(inlierMask);
+        float inlierRatio = static_cast<float>(numInliers) / currPts.size();
+        
+        if (!Hsmall.empty() && inlierRatio >= 0.5f) {
+            // 换算到原始分辨率：H = S^-1 * Hsmall * S
+            cv::Mat S = (cv::Mat_<double>(3, 3) << trackingScale_, 0, 0,
+                                                   0, trackingScale_, 0,
+                                                   0, 0, 1);
+            cv::Mat Hframe = S.inv() * Hsmall * S;
+            
+            motionToKeyframe_ = motionToKeyframe_ * Hframe;
+            if (!keypointHomography_.empty()) {
+                setHomography(keypointHomography_ * motionToKeyframe_);
+            }
+            updated = true;
+            
+            // 保留内点继续跟踪
+            prevFeatures_.clear();
+            for (size_t i = 0; i < currPts.size(); i++) {
+                if (inlierMask[i]) {
+                    prevFeatures_.push_back(currPts[i]);
+                }
+            }
+        }
+    }
     
-    float sumSquaredError = 0.0f;
+    if (!updated) {
+        // 运动估计不可靠，请求关键点模型重新计算
+        driftDetected_ = true;
+        std::cout << "Camera motion tracking lost at frame " << frameNumber << std::endl;
+        prevFeatures_.clear();
+    }
     
-    for (size_t i = 0; i < prev.size(); i++) {
-        float dx = curr[i].x - prev[i].x;
-        float dy = curr[i].y - prev[i].y;
-        sumSquaredError += (dx * dx + dy * dy);
+    cv::swap(prevGray_, currGray_);
+    if (prevFeatures_.size() < 100) {
+        detectTrackingFeatures(playerDetections);
     }
     
-    return std::sqrt(sumSquaredError / prev.size());
+    return updated;
+}
+
+void CoordinateTransform::setHomography(const cv::Mat& H) {
+    homography_ = H;
+    homographyF_ = cv::Matx33f(H);
+    inverseHomographyF_ = cv::Matx33f(cv::Mat(H.inv()));
+}
+
+namespace {
+
+/**
+ * @brief 单应性投影核心：dst[i] = H * src[i]（允许原地运算）
+ * 
+ * 使用OpenCV通用SIMD指令，按通道解交织后一次处理多个点。
+ * |w|过小（点接近地平线）时与 transformPoint 一致，保留原坐标，避免输出inf/nan。
+ */
+void projectPointsKernel(const cv::Matx33f& H, const cv::Point2f* src,
+                         cv::Point2f* dst, size_t count) {
+    const float* s = reinterpret_cast<const float*>(src);
+    float* d = reinterpret_cast<float*>(dst);
+    size_t i = 0;
+    
+#if FA_SIMD_ENABLED
+    const size_t lanes = static_cast<size_t>(simd::lanesF32());
+    const cv::v_float32 h00 = cv::vx_setall_f32(H(0, 0)), h01 = cv::vx_setall_f32(H(0, 1)),
+                        h02 = cv::vx_setall_f32(H(0, 2));
+    const cv::v_float32 h10 = cv::vx_setall_f32(H(1, 0)), h11 = cv::vx_setall_f32(H(1, 1)),
+                        h12 = cv::vx_setall_f32(H(1, 2));
+    const cv::v_float32 h20 = cv::vx_setall_f32(H(2, 0)), h21 = cv::vx_setall_f32(H(2, 1)),
+                        h22 = cv::vx_setall_f32(H(2, 2));
+    const cv::v_float32 minW = cv::vx_setall_f32(1e-6f);
+    
+    for (; i + lanes <= count; i += lanes) {
+        cv::v_float32 x, y;
+        cv::v_load_deinterleave(s + 2 * i, x, y);
+        
+        cv::v_float32 X = cv::v_fma(x, h00, cv::v_fma(y, h01, h02));
+        cv::v_float32 Y = cv::v_fma(x, h10, cv::v_fma(y, h11, h12));
+        cv::v_float32 W = cv::v_fma(x, h20, cv::v_fma(y, h21, h22));
+        
+        // 退化通道的除法结果被丢弃
+        cv::v_float32 degenerate = simd::lt(cv::v_abs(W), minW);
+        cv::v_store_interleave(d + 2 * i,
+                               cv::v_select(degenerate, x, simd::div(X, W)),
+                               cv::v_select(degenerate, y, simd::div(Y, W)));
+    }
+#endif
+    
+    for (; i < count; i++) {
+        float x = s[2 * i];
+        float y = s[2 * i + 1];
+        float w = H(2, 0) * x + H(2, 1) * y + H(2, 2);
+        if (std::abs(w) < 1e-6f) {
+            d[2 * i] = x;
+            d[2 * i + 1] = y;
+            continue;
+        }
+        d[2 * i] = (H(0, 0) * x + H(0, 1) * y + H(0, 2)) / w;
+        d[2 * i + 1] = (H(1, 0) * x + H(1, 1) * y + H(1, 2)) / w;
+    }
+}
+
+} // namespace
+
+void CoordinateTransform::projectPoints(const cv::Point2f* src, cv::Point2f* dst,
+                                        size_t count, bool inverse) const {
+    if (homography_.empty() || count == 0) {
+        if (src != dst) {
+            std::copy(src, src + count, dst);
+        }
+        return;
+    }
+    
+    projectPointsKernel(inverse ? inverseHomographyF_ : homographyF_, src, dst, count);
+}
+
+void CoordinateTransform::projectDetections(const std::vector<Detection>& playerDetections,
+                                            const std::vector<Detection>& ballDetections,
+                                            ProjectionBuffer& out,
+                                            bool includeCorners) const {
+    out.numPlayers = playerDetections.size();
+    out.numBalls = ballDetections.size();
+    out.numCorners = includeCorners ? 4 * playerDetections.size() : 0;
+    out.points.resize(out.numPlayers + out.numBalls + out.numCorners);
+    
+    cv::Point2f* p = out.points.data();
+    
+    // 球员边界框底部中心点（脚的位置）
+    for (const auto& det : playerDetections) {
+        *p++ = cv::Point2f(det.bbox.x + det.bbox.width / 2.0f,
+                           static_cast<float>(det.bbox.y + det.bbox.height));
+    }
+    
+    for (const auto& det : ballDetections) {
+        *p++ = det.center;
+    }
+    
+    if (includeCorners) {
+        for (const auto& det : playerDetections) {
+            float x1 = static_cast<float>(det.bbox.x);
+            float y1 = static_cast<float>(det.bbox.y);
+            float x2 = static_cast<float>(det.bbox.x + det.bbox.width);
+            float y2 = static_cast<float>(det.bbox.y + det.bbox.height);
+            *p++ = cv::Point2f(x1, y1);
+            *p++ = cv::Point2f(x2, y1);
+            *p++ = cv::Point2f(x2, y2);
+            *p++ = cv::Point2f(x1, y2);
+        }
+    }
+    
+    projectPoints(out.points.data(), out.points.data(), out.points.size());
+}
+
+void CoordinateTransform::projectToFrame(const std::vector<cv::Point2f>& tacMapPoints,
+                                         std::vector<cv::Point2f>& framePoints) const {
+    framePoints.resize(tacMapPoints.size());
+    projectPoints(tacMapPoints.data(), framePoints.data(), tacMapPoints.size(), true);
 }
 
 std::vector<cv::Point2f> CoordinateTransform::transformToTacticalMap(
@@ -205,15 +719,15 @@ std::vector<cv::Point2f> CoordinateTransform::transformToTacticalMap(
         return tacMapPositions;
     }
     
+    // 使用球员边界框底部中心点（脚的位置）
+    tacMapPositions.reserve(playerDetections.size());
     for (const auto& det : playerDetections) {
-        // 使用球员边界框底部中心点（脚的位置）
-        cv::Point2f footPos(det.bbox.x + det.bbox.width / 2.0f,
-                           det.bbox.y + det.bbox.height);
-        
-        cv::Point2f transformed = transformPoint(footPos);
-        tacMapPositions.push_back(transformed);
+        tacMapPositions.emplace_back(det.bbox.x + det.bbox.width / 2.0f,
+                                     static_cast<float>(det.bbox.y + det.bbox.height));
     }
     
+    projectPoints(tacMapPositions.data(), tacMapPositions.data(), tacMapPositions.size());
+    
     return tacMapPositions;
 }
 
@@ -222,21 +736,16 @@ cv::Point2f CoordinateTransform::transformPoint(const cv::Point2f& point) {
         return point;
     }
     
-    // 转换为齐次坐标
-    cv::Mat src = (cv::Mat_<double>(3, 1) << point.x, point.y, 1.0);
-    
-    // 应用单应性变换
-    cv::Mat dst = homography_ * src;
-    
-    // 转换回笛卡尔坐标
-    double w = dst.at<double>(2, 0);
-    if (std::abs(w) < 1e-6) {
+    // 使用缓存的单精度矩阵，避免构造临时Mat
+    const cv::Matx33f& H = homographyF_;
+    float w = H(2, 0) * point.x + H(2, 1) * point.y + H(2, 2);
+    if (std::abs(w) < 1e-6f) {
         return point; // 避免除以零
     }
     
     return cv::Point2f(
-        static_cast<float>(dst.at<double>(0, 0) / w),
-        static_cast<float>(dst.at<double>(1, 0) / w)
+        (H(0, 0) * point.x + H(0, 1) * point.y + H(0, 2)) / w,
+        (H(1, 0) * point.x + H(1, 1) * point.y + H(1, 2)) / w
     );
 }
 
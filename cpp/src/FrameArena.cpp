@@ -0,0 +1,92 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <atomic>
+
+namespace FootballAnalytics {
+
+namespace {
+
+std::atomic<long long> gReleases(0);
+std::atomic<long long> gHeapRefills(0);
+std::atomic<size_t> gPeakBytes(0);
+std::atomic<size_t> gMaxCapacity(0);
+
+void updateMax(std::atomic<size_t>& target, size_t value) {
+    size_t current = target.load();
+    while (value > current && !target.compare_exchange_weak(current, value)) {
+    }
+}
+
+} // namespace
+
+FrameArena::FrameArena(size_t initialBytes)
+    : capacity_(std::max<size_t>(initialBytes, 1024))
+    , buffer_(new char[capacity_])
+    , monotonic_(new std::pmr::monotonic_buffer_resource(buffer_.get(), capacity_, &upstream_))
+    , used_(0)
+    , depth_(0)
+{
+    updateMax(gMaxCapacity, capacity_);
+}
+
+FrameArena& FrameArena::local() {
+    thread_local FrameArena arena;
+    return arena;
+}
+
+FrameArenaStats FrameArena::getStats() {
+    FrameArenaStats stats;
+    stats.releases = gReleases.load();
+    stats.heapRefills = gHeapRefills.load();
+    stats.peakBytes = gPeakBytes.load();
+    stats.maxCapacity = gMaxCapacity.load();
+    return stats;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    used_ += bytes;
+    return monotonic_->allocate(bytes, alignment);
+}
+
+void FrameArena::release() {
+    updateMax(gPeakBytes, used_);
+    gReleases++;
+    
+    if (upstream_.refills > 0) {
+        // 本次用量超过预分配缓冲区：按用量的两倍重建（对齐填充也计入余量），之后同等用量不再溢出
+        gHeapRefills += upstream_.refills;
+        upstream_.refills = 0;
+        
+        monotonic_.reset();
+        capacity_ = std::max(capacity_ * 2, used_ * 2);
+        buffer_.reset(new char[capacity_]);
+        monotonic_.reset(new std::pmr::monotonic_buffer_resource(buffer_.get(), capacity_, &upstream_));
+        updateMax(gMaxCapacity, capacity_);
+    } else {
+        monotonic_->release();
+    }
+    used_ = 0;
+}
+
+void* FrameArena::Upstream::do_allocate(size_t bytes, size_t alignment) {
+    refills++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void FrameArena::Upstream::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+FrameArenaScope::FrameArenaScope()
+    : arena_(FrameArena::local())
+{
+    arena_.depth_++;
+}
+
+FrameArenaScope::~FrameArenaScope() {
+    if (--arena_.depth_ == 0) {
+        arena_.release();
+    }
+}
+
+} // namespace FootballAnalytics
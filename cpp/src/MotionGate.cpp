@@ -0,0 +1,62 @@
+#include "MotionGate.h"
+#include <algorithm>
+#include <chrono>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr int kFingerprintWidth = 64;   // 亮度指纹宽度（高度按图像比例）
+
+} // namespace
+
+MotionGate::MotionGate(float threshold, int maxReuse)
+    : threshold_(std::max(threshold, 0.0f))
+    , maxReuse_(std::max(maxReuse, 1))
+    , consecutiveReuse_(0)
+    , hasReference_(false)
+{
+}
+
+void MotionGate::reset() {
+    hasReference_ = false;
+    consecutiveReuse_ = 0;
+}
+
+bool MotionGate::shouldReuse(const cv::Mat& frame) {
+    if (!isEnabled() || frame.empty()) {
+        return false;
+    }
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    // 先缩小再转灰度（INTER_AREA平均，对噪声和压缩块不敏感）
+    int height = std::max(1, cvRound(static_cast<double>(kFingerprintWidth) * frame.rows / frame.cols));
+    cv::resize(frame, small_, cv::Size(kFingerprintWidth, height), 0, 0, cv::INTER_AREA);
+    cv::cvtColor(small_, fingerprint_, cv::COLOR_BGR2GRAY);
+    
+    bool reuse = false;
+    if (hasReference_ && fingerprint_.size() == reference_.size()) {
+        stats_.lastDifference = static_cast<float>(
+            cv::norm(fingerprint_, reference_, cv::NORM_L1) / fingerprint_.total());
+        reuse = stats_.lastDifference < threshold_ && consecutiveReuse_ < maxReuse_;
+    }
+    
+    if (reuse) {
+        consecutiveReuse_++;
+        stats_.reusedFrames++;
+    } else {
+        // 当前帧将被完整分析，成为新的参考帧
+        cv::swap(fingerprint_, reference_);
+        hasReference_ = true;
+        consecutiveReuse_ = 0;
+    }
+    
+    stats_.frames++;
+    stats_.totalMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    
+    return reuse;
+}
+
+} // namespace FootballAnalytics
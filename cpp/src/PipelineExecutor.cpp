@@ -0,0 +1,253 @@
+#include "PipelineExecutor.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr int kSpinsBeforeSleep = 64;      // 队列满/空时先让出CPU若干次，再短暂休眠
+constexpr int kSleepMicroseconds = 100;
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+void backoff(int& spins) {
+    if (++spins < kSpinsBeforeSleep) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(kSleepMicroseconds));
+    }
+}
+
+} // namespace
+
+void PipelineFrame::reset() {
+    index = 0;
+    data.clear();
+    
+    detections.clear();
+    keypoints.clear();
+    detected = false;
+    keypointsDetected = false;
+    detectMs = 0.0;
+    json.clear();
+}
+
+PipelineExecutor::PipelineExecutor(int maxInFlight)
+    : maxInFlight_(std::max(maxInFlight, 2))
+{
+}
+
+void PipelineExecutor::addStage(const std::string& name, const StageFunc& func, int workers) {
+    stages_.push_back({name, func, std::max(workers, 1)});
+}
+
+void PipelineExecutor::run(const SourceFunc& source, const SinkFunc& sink) {
+    // 帧池：首次运行时分配，之后跨运行复用
+    if (pool_.empty()) {
+        for (int i = 0; i < maxInFlight_; i++) {
+            pool_.emplace_back(new PipelineFrame());
+        }
+    }
+    freeFrames_.reset(new FrameQueue(maxInFlight_));
+    for (auto& item : pool_) {
+        freeFrames_->tryPush(item.get());
+    }
+    
+    // 在途帧数不超过帧池大小，队列另外预留结束标记的位置，入队不会长时间等待
+    int maxWorkers = 1;
+    for (const auto& stage : stages_) {
+        maxWorkers = std::max(maxWorkers, stage.workers);
+    }
+    queues_.clear();
+    activeWorkers_.clear();
+    for (size_t i = 0; i <= stages_.size(); i++) {
+        queues_.emplace_back(new FrameQueue(maxInFlight_ + maxWorkers));
+    }
+    for (const auto& stage : stages_) {
+        activeWorkers_.emplace_back(new std::atomic<int>(stage.workers));
+    }
+    
+    stats_.clear();
+    stats_.push_back(StageStats());
+    stats_.back().name = "source";
+    for (const auto& stage : stages_) {
+        stats_.push_back(StageStats());
+        stats_.back().name = stage.name;
+        stats_.back().workers = stage.workers;
+    }
+    stats_.push_back(StageStats());
+    stats_.back().name = "sink";
+    
+    std::vector<std::thread> threads;
+    threads.emplace_back(&PipelineExecutor::runSource, this, std::cref(source));
+    for (size_t i = 0; i < stages_.size(); i++) {
+        for (int w = 0; w < stages_[i].workers; w++) {
+            threads.emplace_back(&PipelineExecutor::runStage, this, i, w);
+        }
+    }
+    
+    // 输出在调用线程中按帧序执行，完成后帧归还帧池
+    std::vector<PipelineFrame*> pending(maxInFlight_, nullptr);
+    long long nextIndex = 0;
+    bool finished = false;
+    long long frames = 0;
+    double busyMs = 0.0;
+    double waitMs = 0.0;
+    while (PipelineFrame* item = popOrdered(*queues_.back(), pending, nextIndex, finished, waitMs)) {
+        auto startTime = Clock::now();
+        try {
+            sink(*item);
+        } catch (const std::exception& e) {
+            std::cerr << "Pipeline sink failed on frame " << item->index << ": " << e.what() << std::endl;
+        }
+        busyMs += elapsedMs(startTime);
+        frames++;
+        push(*freeFrames_, item);
+    }
+    addStats(stats_.size() - 1, frames, busyMs, waitMs);
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void PipelineExecutor::runSource(const SourceFunc& source) {
+    long long index = 0;
+    double busyMs = 0.0;
+    double waitMs = 0.0;
+    
+    for (;;) {
+        PipelineFrame* item = pop(*freeFrames_, waitMs);
+        item->reset();
+        item->index = index;
+        
+        auto startTime = Clock::now();
+        bool hasFrame = false;
+        try {
+            hasFrame = source(*item);
+        } catch (const std::exception& e) {
+            std::cerr << "Pipeline source failed on frame " << index << ": " << e.what() << std::endl;
+        }
+        busyMs += elapsedMs(startTime);
+        
+        if (!hasFrame) {
+            push(*freeFrames_, item);
+            break;
+        }
+        index++;
+        push(*queues_[0], item);
+    }
+    
+    closeQueue(0);
+    addStats(0, index, busyMs, waitMs);
+}
+
+void PipelineExecutor::runStage(size_t stageIndex, int worker) {
+    const Stage& stage = stages_[stageIndex];
+    FrameQueue& input = *queues_[stageIndex];
+    FrameQueue& output = *queues_[stageIndex + 1];
+    
+    // 单工作线程的阶段按帧序处理，上游乱序到达的帧先暂存
+    bool ordered = stage.workers == 1;
+    std::vector<PipelineFrame*> pending(ordered ? maxInFlight_ : 0, nullptr);
+    long long nextIndex = 0;
+    bool finished = false;
+    long long frames = 0;
+    double busyMs = 0.0;
+    double waitMs = 0.0;
+    
+    for (;;) {
+        PipelineFrame* item = ordered ? popOrdered(input, pending, nextIndex, finished, waitMs)
+                                      : pop(input, waitMs);
+        if (!item) {
+            break;
+        }
+        
+        auto startTime = Clock::now();
+        try {
+            stage.func(*item, worker);
+        } catch (const std::exception& e) {
+            std::cerr << "Pipeline stage '" << stage.name << "' failed on frame " << item->index
+                     << ": " << e.what() << std::endl;
+        }
+        busyMs += elapsedMs(startTime);
+        frames++;
+        push(output, item);
+    }
+    
+    // 最后一个退出的工作线程负责通知下游（此时本阶段的帧均已入队）
+    if (activeWorkers_[stageIndex]->fetch_sub(1) == 1) {
+        closeQueue(stageIndex + 1);
+    }
+    addStats(stageIndex + 1, frames, busyMs, waitMs);
+}
+
+PipelineFrame* PipelineExecutor::popOrdered(FrameQueue& queue, std::vector<PipelineFrame*>& pending,
+                                            long long& nextIndex, bool& finished, double& waitMs) {
+    // 在途帧数不超过帧池大小，暂存的帧序号落在 [nextIndex, nextIndex + maxInFlight) 内，按余数存放不会冲突
+    for (;;) {
+        PipelineFrame*& slot = pending[nextIndex % maxInFlight_];
+        if (slot && slot->index == nextIndex) {
+            PipelineFrame* item = slot;
+            slot = nullptr;
+            nextIndex++;
+            return item;
+        }
+        if (finished) {
+            return nullptr;
+        }
+        
+        PipelineFrame* item = pop(queue, waitMs);
+        if (!item) {
+            finished = true;
+            continue;
+        }
+        pending[item->index % maxInFlight_] = item;
+    }
+}
+
+PipelineFrame* PipelineExecutor::pop(FrameQueue& queue, double& waitMs) {
+    PipelineFrame* item = nullptr;
+    if (queue.tryPop(item)) {
+        return item;
+    }
+    
+    auto startTime = Clock::now();
+    int spins = 0;
+    while (!queue.tryPop(item)) {
+        backoff(spins);
+    }
+    waitMs += elapsedMs(startTime);
+    return item;
+}
+
+void PipelineExecutor::push(FrameQueue& queue, PipelineFrame* item) {
+    int spins = 0;
+    while (!queue.tryPush(item)) {
+        backoff(spins);
+    }
+}
+
+void PipelineExecutor::closeQueue(size_t queueIndex) {
+    int consumers = queueIndex < stages_.size() ? stages_[queueIndex].workers : 1;
+    for (int i = 0; i < consumers; i++) {
+        push(*queues_[queueIndex], nullptr);
+    }
+}
+
+void PipelineExecutor::addStats(size_t statsIndex, long long frames, double busyMs, double waitMs) {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    StageStats& stats = stats_[statsIndex];
+    stats.frames += frames;
+    stats.busyMs += busyMs;
+    stats.waitMs += waitMs;
+}
+
+} // namespace FootballAnalytics
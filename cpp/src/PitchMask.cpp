@@ -0,0 +1,165 @@
+#include "PitchMask.h"
+#include <algorithm>
+#include <chrono>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr float kMinCoverage = 0.15f;   // 掩码覆盖比例低于该值时视为非全景画面，不做过滤
+
+// 草地HSV范围（OpenCV色调0~180）
+const cv::Scalar kGrassLower(30, 40, 40);
+const cv::Scalar kGrassUpper(90, 255, 255);
+
+} // namespace
+
+PitchMask::PitchMask(int maskWidth, int refreshInterval, float margin)
+    : maskWidth_(std::max(maskWidth, 32))
+    , refreshInterval_(std::max(refreshInterval, 1))
+    , margin_(std::max(margin, 0.0f))
+    , source_(PitchMaskSource::Auto)
+    , valid_(false)
+    , lastUpdateFrame_(-1)
+    , lastHomographyUpdates_(-1)
+    , scaleX_(1.0f)
+    , scaleY_(1.0f)
+{
+}
+
+void PitchMask::reset() {
+    valid_ = false;
+    lastUpdateFrame_ = -1;
+    lastHomographyUpdates_ = -1;
+}
+
+bool PitchMask::contains(const cv::Point2f& point) const {
+    if (!valid_) {
+        return true;
+    }
+    
+    int x = std::min(std::max(static_cast<int>(point.x * scaleX_), 0), mask_.cols - 1);
+    int y = std::min(std::max(static_cast<int>(point.y * scaleY_), 0), mask_.rows - 1);
+    return mask_.at<uchar>(y, x) != 0;
+}
+
+bool PitchMask::update(const cv::Mat& frame, int frameNumber,
+                       const CoordinateTransform& coordTransform) {
+    if (frame.empty()) {
+        return false;
+    }
+    
+    const HomographyStats& homographyStats = coordTransform.getHomographyStats();
+    int homographyUpdates = homographyStats.warmStartUpdates + homographyStats.robustUpdates;
+    
+    // 增量更新：画面与球场位置在相邻帧间变化很小，只在必要时重新计算
+    bool refresh = lastUpdateFrame_ < 0 ||
+                   frame.size() != frameSize_ ||
+                   frameNumber - lastUpdateFrame_ >= refreshInterval_ ||
+                   homographyUpdates != lastHomographyUpdates_;
+    if (!refresh) {
+        return false;
+    }
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    if (frame.size() != frameSize_) {
+        frameSize_ = frame.size();
+        int maskHeight = std::max(1, cvRound(static_cast<double>(maskWidth_) * frame.rows / frame.cols));
+        scaleX_ = static_cast<float>(maskWidth_) / frame.cols;
+        scaleY_ = static_cast<float>(maskHeight) / frame.rows;
+        mask_.create(maskHeight, maskWidth_, CV_8U);
+    }
+    
+    bool useOutline = source_ == PitchMaskSource::Outline ||
+                      (source_ == PitchMaskSource::Auto && coordTransform.hasValidHomography());
+    bool found = useOutline ? computeFromOutline(coordTransform) : computeFromGrass(frame);
+    
+    // 向外扩展边距，保留站在边线附近（脚底点略出界）的球员
+    int marginPx = cvRound(margin_ * maskWidth_);
+    if (found && marginPx > 0) {
+        cv::dilate(mask_, mask_, cv::getStructuringElement(
+            cv::MORPH_RECT, cv::Size(2 * marginPx + 1, 2 * marginPx + 1)));
+    }
+    
+    stats_.coverage = found ? static_cast<float>(cv::countNonZero(mask_)) / mask_.total() : 0.0f;
+    valid_ = stats_.coverage >= kMinCoverage;
+    
+    lastUpdateFrame_ = frameNumber;
+    lastHomographyUpdates_ = homographyUpdates;
+    
+    stats_.updates++;
+    if (useOutline) {
+        stats_.outlineUpdates++;
+    }
+    if (!valid_) {
+        stats_.invalidUpdates++;
+    }
+    stats_.totalMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    
+    return true;
+}
+
+bool PitchMask::computeFromGrass(const cv::Mat& frame) {
+    cv::resize(frame, small_, mask_.size(), 0, 0, cv::INTER_AREA);
+    cv::cvtColor(small_, hsv_, cv::COLOR_BGR2HSV);
+    cv::inRange(hsv_, kGrassLower, kGrassUpper, grass_);
+    
+    // 闭运算填补球场线和球员造成的空洞
+    cv::morphologyEx(grass_, grass_, cv::MORPH_CLOSE,
+                     cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(5, 5)));
+    
+    contours_.clear();
+    cv::findContours(grass_, contours_, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    
+    // 最大草地连通域的凸包即球场（包含场内的球员和裁判）
+    int best = -1;
+    double bestArea = 0.0;
+    for (size_t i = 0; i < contours_.size(); i++) {
+        double area = cv::contourArea(contours_[i]);
+        if (area > bestArea) {
+            bestArea = area;
+            best = static_cast<int>(i);
+        }
+    }
+    
+    mask_.setTo(0);
+    if (best < 0) {
+        return false;
+    }
+    
+    cv::convexHull(contours_[best], hull_);
+    cv::fillConvexPoly(mask_, hull_, cv::Scalar(255));
+    return true;
+}
+
+bool PitchMask::computeFromOutline(const CoordinateTransform& coordTransform) {
+    cv::Rect2f bounds = coordTransform.getPitchBounds();
+    if (!coordTransform.hasValidHomography() || bounds.area() <= 0.0f) {
+        mask_.setTo(0);
+        return false;
+    }
+    
+    // 战术地图坐标下的球场范围（只在尺寸变化时重新生成）
+    cv::Size templateSize(cvCeil(bounds.br().x) + 1, cvCeil(bounds.br().y) + 1);
+    if (pitchTemplate_.size() != templateSize) {
+        pitchTemplate_ = cv::Mat::zeros(templateSize, CV_8U);
+        cv::rectangle(pitchTemplate_, cv::Point(cvFloor(bounds.x), cvFloor(bounds.y)),
+                      cv::Point(cvCeil(bounds.br().x), cvCeil(bounds.br().y)),
+                      cv::Scalar(255), cv::FILLED);
+    }
+    
+    // 掩码像素 -> 原图 -> 战术地图，逐像素反向映射
+    cv::Matx33d maskToFrame(1.0 / scaleX_, 0, 0,
+                            0, 1.0 / scaleY_, 0,
+                            0, 0, 1);
+    cv::Mat frameToMap;
+    coordTransform.getHomography().convertTo(frameToMap, CV_64F);
+    cv::Mat maskToMap = frameToMap * cv::Mat(maskToFrame);
+    cv::warpPerspective(pitchTemplate_, mask_, maskToMap, mask_.size(),
+                        cv::INTER_NEAREST | cv::WARP_INVERSE_MAP, cv::BORDER_CONSTANT, cv::Scalar(0));
+    return true;
+}
+
+} // namespace FootballAnalytics
@@ -0,0 +1,605 @@
+#include "PlayerTracker.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cmath>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr float kStdWeightPosition = 1.0f / 20.0f;   // 位置噪声（相对框高）
+constexpr float kStdWeightVelocity = 1.0f / 160.0f;  // 速度噪声（相对框高）
+constexpr float kFirstMatchMaxCost = 0.8f;           // 高分匹配：IoU >= 0.2
+constexpr float kSecondMatchMaxCost = 0.5f;          // 低分匹配：IoU >= 0.5
+constexpr float kInvalidCost = 2.0f;                 // 超出门限的代价
+constexpr int kFlowWidth = 960;                      // 光流图像宽度上限
+constexpr int kFlowGrid = 3;                         // 每个球员框内的采样网格（3x3）
+constexpr int kFlowMinPoints = 3;                    // 修正所需的最少有效点数
+constexpr float kFlowMaxError = 20.0f;               // LK误差上限
+constexpr float kDriftBudget = 0.3f;                 // 两次检测之间允许的累计位移（相对框高）
+constexpr float kMotionSmoothing = 0.3f;             // 运动量指数平滑系数
+
+inline float boxIoU(const cv::Rect2f& a, const cv::Rect2f& b) {
+    float x1 = std::max(a.x, b.x);
+    float y1 = std::max(a.y, b.y);
+    float x2 = std::min(a.x + a.width, b.x + b.width);
+    float y2 = std::min(a.y + a.height, b.y + b.height);
+    float inter = std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+    float uni = a.area() + b.area() - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+/**
+ * @brief 匈牙利算法（势函数 + 最短增广路，O(n²m)），要求 rows <= cols
+ * @param cost 行优先代价矩阵
+ * @param rowMatch 输出每行匹配的列
+ * @param ws 工作缓冲区（保留容量，预热后不再分配）
+ */
+void hungarian(const float* cost, int rows, int cols, int* rowMatch, AssignmentWorkspace& ws) {
+    const float inf = std::numeric_limits<float>::max();
+    ws.u.assign(rows + 1, 0.0f);
+    ws.v.assign(cols + 1, 0.0f);
+    ws.minv.resize(cols + 1);
+    ws.p.assign(cols + 1, 0);
+    ws.way.assign(cols + 1, 0);
+    ws.used.resize(cols + 1);
+    std::vector<float>& u = ws.u;
+    std::vector<float>& v = ws.v;
+    std::vector<float>& minv = ws.minv;
+    std::vector<int>& p = ws.p;
+    std::vector<int>& way = ws.way;
+    std::vector<char>& used = ws.used;
+    
+    for (int i = 1; i <= rows; i++) {
+        p[0] = i;
+        int j0 = 0;
+        std::fill(minv.begin(), minv.end(), inf);
+        std::fill(used.begin(), used.end(), 0);
+        
+        do {
+            used[j0] = 1;
+            int i0 = p[j0];
+            int j1 = 0;
+            float delta = inf;
+            for (int j = 1; j <= cols; j++) {
+                if (used[j]) {
+                    continue;
+                }
+                float cur = cost[(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= cols; j++) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    
+    std::fill(rowMatch, rowMatch + rows, -1);
+    for (int j = 1; j <= cols; j++) {
+        if (p[j] != 0) {
+            rowMatch[p[j] - 1] = j - 1;
+        }
+    }
+}
+
+/**
+ * @brief 任意形状的线性分配（行多于列时转置求解）
+ */
+void solveAssignment(const std::vector<float>& cost, int rows, int cols, std::vector<int>& rowMatch,
+                     AssignmentWorkspace& ws) {
+    rowMatch.assign(rows, -1);
+    if (rows <= cols) {
+        hungarian(cost.data(), rows, cols, rowMatch.data(), ws);
+        return;
+    }
+    
+    std::vector<float>& transposed = ws.transposed;
+    transposed.resize(static_cast<size_t>(rows) * cols);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            transposed[c * rows + r] = cost[r * cols + c];
+        }
+    }
+    
+    std::vector<int>& colMatch = ws.colMatch;
+    colMatch.resize(cols);
+    hungarian(transposed.data(), cols, rows, colMatch.data(), ws);
+    for (int c = 0; c < cols; c++) {
+        if (colMatch[c] >= 0) {
+            rowMatch[colMatch[c]] = c;
+        }
+    }
+}
+
+} // namespace
+
+PlayerTracker::PlayerTracker(float highThreshold, float lowThreshold,
+                             float newTrackThreshold, int maxLostFrames)
+    : highThreshold_(highThreshold)
+    , lowThreshold_(lowThreshold)
+    , newTrackThreshold_(newTrackThreshold)
+    , maxLostFrames_(maxLostFrames)
+    , frameCount_(0)
+    , nextTrackId_(0)
+    , flowRefinement_(false)
+    , flowScale_(1.0)
+{
+}
+
+void PlayerTracker::setFlowRefinement(bool enable) {
+    flowRefinement_ = enable;
+    if (!enable) {
+        prevGray_.release();
+    }
+}
+
+void PlayerTracker::reset() {
+    tracks_.clear();
+    prevGray_.release();
+    stats_.activeTracks = 0;
+    stats_.meanMotion = 0.0f;
+}
+
+cv::Rect2f PlayerTracker::stateToBox(const StateVec& mean) {
+    float h = mean[3];
+    float w = mean[2] * h;
+    return cv::Rect2f(mean[0] - w * 0.5f, mean[1] - h * 0.5f, w, h);
+}
+
+void PlayerTracker::predict(Track& track) const {
+    StateVec& x = track.mean;
+    if (track.state != TrackState::Tracked) {
+        x[7] = 0.0f;
+    }
+    
+    float h = x[3];
+    float stdPos = kStdWeightPosition * h;
+    float stdVel = kStdWeightVelocity * h;
+    
+    // 匀速模型：位置 += 速度
+    StateCov F = StateCov::eye();
+    for (int i = 0; i < 4; i++) {
+        F(i, i + 4) = 1.0f;
+        x[i] += x[i + 4];
+    }
+    
+    StateCov Q = StateCov::zeros();
+    Q(0, 0) = Q(1, 1) = Q(3, 3) = stdPos * stdPos;
+    Q(2, 2) = 1e-2f * 1e-2f;
+    Q(4, 4) = Q(5, 5) = Q(7, 7) = stdVel * stdVel;
+    Q(6, 6) = 1e-5f * 1e-5f;
+    
+    track.covariance = F * track.covariance * F.t() + Q;
+}
+
+void PlayerTracker::correct(Track& track, const cv::Rect& bbox) const {
+    cv::Vec4f z(bbox.x + bbox.width * 0.5f, bbox.y + bbox.height * 0.5f,
+                bbox.height > 0 ? static_cast<float>(bbox.width) / bbox.height : 0.0f,
+                static_cast<float>(bbox.height));
+    
+    StateVec& x = track.mean;
+    StateCov& P = track.covariance;
+    
+    float stdPos = kStdWeightPosition * x[3];
+    cv::Matx44f S = P.get_minor<4, 4>(0, 0);
+    S(0, 0) += stdPos * stdPos;
+    S(1, 1) += stdPos * stdPos;
+    S(2, 2) += 1e-1f * 1e-1f;
+    S(3, 3) += stdPos * stdPos;
+    
+    // K = P Hᵀ S⁻¹，H取状态的前4维
+    cv::Matx<float, 8, 4> K = P.get_minor<8, 4>(0, 0) * S.inv(cv::DECOMP_CHOLESKY);
+    
+    cv::Vec4f innovation(z[0] - x[0], z[1] - x[1], z[2] - x[2], z[3] - x[3]);
+    x += K * innovation;
+    P -= K * P.get_minor<4, 8>(0, 0);
+}
+
+void PlayerTracker::startTrack(const Detection& det, bool activate) {
+    const cv::Rect& b = det.bbox;
+    float h = static_cast<float>(b.height);
+    
+    Track track;
+    track.id = nextTrackId_++;
+    track.state = activate ? TrackState::Tracked : TrackState::New;
+    track.mean = StateVec(b.x + b.width * 0.5f, b.y + b.height * 0.5f,
+                          h > 0.0f ? b.width / h : 0.0f, h,
+                          0.0f, 0.0f, 0.0f, 0.0f);
+    
+    float stdPos = 2.0f * kStdWeightPosition * h;
+    float stdVel = 10.0f * kStdWeightVelocity * h;
+    track.covariance = StateCov::zeros();
+    track.covariance(0, 0) = track.covariance(1, 1) = track.covariance(3, 3) = stdPos * stdPos;
+    track.covariance(2, 2) = 1e-2f * 1e-2f;
+    track.covariance(4, 4) = track.covariance(5, 5) = track.covariance(7, 7) = stdVel * stdVel;
+    track.covariance(6, 6) = 1e-5f * 1e-5f;
+    track.lastFrame = frameCount_;
+    track.score = det.confidence;
+    track.classId = det.classId;
+    track.label = det.label;
+    
+    tracks_.push_back(track);
+    stats_.tracksCreated++;
+}
+
+void PlayerTracker::associate(const std::vector<int>& dets,
+                              std::vector<Detection>& detections,
+                              float maxCost) {
+    int rows = static_cast<int>(dets.size());
+    int cols = static_cast<int>(poolTracks_.size());
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+    
+    trackBoxes_.resize(cols);
+    for (int c = 0; c < cols; c++) {
+        trackBoxes_[c] = stateToBox(tracks_[poolTracks_[c]].mean);
+    }
+    
+    // 代价 = 1 - IoU，超出门限的置为固定大值
+    cost_.resize(static_cast<size_t>(rows) * cols);
+    for (int r = 0; r < rows; r++) {
+        cv::Rect2f detBox(detections[dets[r]].bbox);
+        for (int c = 0; c < cols; c++) {
+            float cost = 1.0f - boxIoU(detBox, trackBoxes_[c]);
+            cost_[r * cols + c] = cost <= maxCost ? cost : kInvalidCost;
+        }
+    }
+    
+    solveAssignment(cost_, rows, cols, rowMatch_, assignment_);
+    
+    for (int r = 0; r < rows; r++) {
+        int c = rowMatch_[r];
+        if (c < 0 || cost_[r * cols + c] > maxCost) {
+            continue;
+        }
+        
+        Detection& det = detections[dets[r]];
+        Track& track = tracks_[poolTracks_[c]];
+        correct(track, det.bbox);
+        track.state = TrackState::Tracked;
+        track.lastFrame = frameCount_;
+        track.score = det.confidence;
+        trackMatched_[poolTracks_[c]] = 1;
+        keep_[dets[r]] = 1;
+        det.trackId = track.id;
+    }
+}
+
+void PlayerTracker::update(std::vector<Detection>& detections, const cv::Mat& frame) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    frameCount_++;
+    
+    // 没有任何轨迹时（首帧或重置后）新轨迹立即确认
+    bool bootstrap = tracks_.empty();
+    
+    // 1. 按置信度划分高分/低分检测
+    highDets_.clear();
+    lowDets_.clear();
+    keep_.assign(detections.size(), 0);
+    for (size_t i = 0; i < detections.size(); i++) {
+        Detection& det = detections[i];
+        det.trackId = -1;
+        det.predicted = false;
+        if (det.confidence >= highThreshold_) {
+            highDets_.push_back(static_cast<int>(i));
+            keep_[i] = 1;
+        } else if (det.confidence >= lowThreshold_) {
+            lowDets_.push_back(static_cast<int>(i));
+        }
+    }
+    
+    // 2. 预测所有轨迹
+    for (auto& track : tracks_) {
+        predict(track);
+    }
+    trackMatched_.assign(tracks_.size(), 0);
+    
+    // 3. 第一轮：高分检测与所有轨迹匹配
+    poolTracks_.clear();
+    for (size_t t = 0; t < tracks_.size(); t++) {
+        poolTracks_.push_back(static_cast<int>(t));
+    }
+    associate(highDets_, detections, kFirstMatchMaxCost);
+    
+    // 4. 第二轮：低分检测与剩余的跟踪中轨迹匹配（遮挡/模糊时延续轨迹）
+    poolTracks_.clear();
+    for (size_t t = 0; t < tracks_.size(); t++) {
+        if (!trackMatched_[t] && tracks_[t].state == TrackState::Tracked) {
+            poolTracks_.push_back(static_cast<int>(t));
+        }
+    }
+    associate(lowDets_, detections, kSecondMatchMaxCost);
+    
+    // 5. 未匹配轨迹：新轨迹直接删除，跟踪中转为丢失，丢失过久删除
+    size_t write = 0;
+    for (size_t t = 0; t < tracks_.size(); t++) {
+        Track& track = tracks_[t];
+        if (!trackMatched_[t]) {
+            if (track.state == TrackState::New ||
+                frameCount_ - track.lastFrame > maxLostFrames_) {
+                continue;
+            }
+            track.state = TrackState::Lost;
+        }
+        if (write != t) {
+            tracks_[write] = track;
+        }
+        write++;
+    }
+    tracks_.resize(write);
+    
+    // 6. 未匹配的高分检测创建新轨迹
+    for (int d : highDets_) {
+        Detection& det = detections[d];
+        if (det.trackId < 0 && det.confidence >= newTrackThreshold_) {
+            startTrack(det, bootstrap);
+            det.trackId = tracks_.back().id;
+        }
+    }
+    
+    // 7. 移除未延续轨迹的低分检测（保持原有顺序）
+    write = 0;
+    for (size_t i = 0; i < detections.size(); i++) {
+        if (!keep_[i]) {
+            continue;
+        }
+        if (write != i) {
+            detections[write] = std::move(detections[i]);
+        }
+        write++;
+    }
+    detections.resize(write);
+    
+    // 保存灰度图供下一预测帧的光流使用
+    if (flowRefinement_ && !frame.empty()) {
+        makeFlowImage(frame, prevGray_);
+    }
+    
+    // 统计
+    updateMotionStats();
+    
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    stats_.frames++;
+    stats_.totalMs += ms;
+    stats_.maxMs = std::max(stats_.maxMs, ms);
+}
+
+void PlayerTracker::updateMotionStats() {
+    stats_.activeTracks = 0;
+    float motionSum = 0.0f;
+    for (const auto& track : tracks_) {
+        if (track.state == TrackState::Tracked) {
+            stats_.activeTracks++;
+            const StateVec& x = track.mean;
+            if (x[3] > 0.0f) {
+                motionSum += std::sqrt(x[4] * x[4] + x[5] * x[5]) / x[3];
+            }
+        }
+    }
+    stats_.meanMotion = stats_.activeTracks > 0 ? motionSum / stats_.activeTracks : 0.0f;
+}
+
+void PlayerTracker::makeFlowImage(const cv::Mat& frame, cv::Mat& gray) {
+    flowScale_ = std::min(1.0, static_cast<double>(kFlowWidth) / frame.cols);
+    if (flowScale_ < 1.0) {
+        cv::Mat small;
+        cv::resize(frame, small, cv::Size(), flowScale_, flowScale_, cv::INTER_AREA);
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    }
+}
+
+void PlayerTracker::refineWithFlow() {
+    // 在每个跟踪中轨迹（预测前位置）的躯干区域采样网格点，所有球员一次LK调用
+    flowPrev_.clear();
+    flowTrack_.clear();
+    const float scale = static_cast<float>(flowScale_);
+    
+    for (size_t t = 0; t < tracks_.size(); t++) {
+        if (tracks_[t].state != TrackState::Tracked) {
+            continue;
+        }
+        cv::Rect2f box = stateToBox(tracks_[t].mean);
+        for (int gy = 0; gy < kFlowGrid; gy++) {
+            for (int gx = 0; gx < kFlowGrid; gx++) {
+                // 取框的上2/3（躯干），腿部运动与整体位移不一致
+                float px = box.x + box.width * (gx + 1) / (kFlowGrid + 1);
+                float py = box.y + box.height * 2.0f / 3.0f * (gy + 1) / (kFlowGrid + 1);
+                flowPrev_.emplace_back(px * scale, py * scale);
+            }
+        }
+        flowTrack_.push_back(static_cast<int>(t));
+    }
+    
+    if (flowPrev_.empty()) {
+        return;
+    }
+    
+    cv::calcOpticalFlowPyrLK(prevGray_, gray_, flowPrev_, flowCurr_, flowStatus_, flowError_,
+                             cv::Size(15, 15), 2);
+    
+    const int pointsPerTrack = kFlowGrid * kFlowGrid;
+    float dx[kFlowGrid * kFlowGrid];
+    float dy[kFlowGrid * kFlowGrid];
+    
+    for (size_t k = 0; k < flowTrack_.size(); k++) {
+        int valid = 0;
+        for (int p = 0; p < pointsPerTrack; p++) {
+            size_t idx = k * pointsPerTrack + p;
+            if (flowStatus_[idx] && flowError_[idx] < kFlowMaxError) {
+                dx[valid] = (flowCurr_[idx].x - flowPrev_[idx].x) / scale;
+                dy[valid] = (flowCurr_[idx].y - flowPrev_[idx].y) / scale;
+                valid++;
+            }
+        }
+        if (valid < kFlowMinPoints) {
+            continue;
+        }
+        
+        std::nth_element(dx, dx + valid / 2, dx + valid);
+        std::nth_element(dy, dy + valid / 2, dy + valid);
+        
+        // 上一帧位置平移中值位移作为本帧观测
+        Track& track = tracks_[flowTrack_[k]];
+        cv::Rect2f box = stateToBox(track.mean);
+        cv::Rect observed(cvRound(box.x + dx[valid / 2]), cvRound(box.y + dy[valid / 2]),
+                          cvRound(box.width), cvRound(box.height));
+        predict(track);
+        correct(track, observed);
+        flowTrack_[k] = -1;  // 已预测
+    }
+    
+    // 光流失败的轨迹只做运动模型预测
+    for (size_t k = 0; k < flowTrack_.size(); k++) {
+        if (flowTrack_[k] >= 0) {
+            predict(tracks_[flowTrack_[k]]);
+        }
+    }
+}
+
+void PlayerTracker::predictOnly(std::vector<Detection>& detections, const cv::Mat& frame) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    frameCount_++;
+    detections.clear();
+    
+    bool useFlow = flowRefinement_ && !frame.empty();
+    if (useFlow) {
+        makeFlowImage(frame, gray_);
+        useFlow = !prevGray_.empty() && prevGray_.size() == gray_.size();
+    }
+    
+    // 1. 预测（跟踪中轨迹可由光流修正）
+    for (auto& track : tracks_) {
+        if (!useFlow || track.state != TrackState::Tracked) {
+            predict(track);
+        }
+    }
+    if (useFlow) {
+        refineWithFlow();
+    }
+    
+    // 2. 丢失过久的轨迹删除
+    tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                                [this](const Track& track) {
+                                    return track.state == TrackState::Lost &&
+                                           frameCount_ - track.lastFrame > maxLostFrames_;
+                                }),
+                  tracks_.end());
+    
+    // 3. 输出跟踪中轨迹的预测框
+    for (const auto& track : tracks_) {
+        if (track.state != TrackState::Tracked) {
+            continue;
+        }
+        cv::Rect2f box = stateToBox(track.mean);
+        Detection det;
+        det.bbox = cv::Rect(cvRound(box.x), cvRound(box.y), cvRound(box.width), cvRound(box.height));
+        det.center = cv::Point2f(box.x + box.width * 0.5f, box.y + box.height * 0.5f);
+        det.classId = track.classId;
+        det.label = track.label;
+        det.confidence = track.score;
+        det.trackId = track.id;
+        det.predicted = true;
+        detections.push_back(det);
+    }
+    
+    if (flowRefinement_ && !gray_.empty()) {
+        cv::swap(prevGray_, gray_);
+    }
+    
+    updateMotionStats();
+    
+    stats_.predictedFrames++;
+    stats_.predictMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void PredictionEval::accumulate(const std::vector<Detection>& predicted,
+                                const std::vector<Detection>& detected,
+                                float minConfidence) {
+    frames++;
+    
+    // 每个完整检测的球员取IoU最大的预测框
+    for (const auto& det : detected) {
+        if (det.classId != 0 || det.confidence < minConfidence) {
+            continue;
+        }
+        detectedBoxes++;
+        
+        cv::Rect2f detBox(det.bbox);
+        float bestIoU = 0.0f;
+        const Detection* best = nullptr;
+        for (const auto& pred : predicted) {
+            float iou = boxIoU(detBox, cv::Rect2f(pred.bbox));
+            if (iou > bestIoU) {
+                bestIoU = iou;
+                best = &pred;
+            }
+        }
+        
+        if (best != nullptr && bestIoU >= 0.3f) {
+            matchedBoxes++;
+            iouSum += bestIoU;
+            centerErrorPx += cv::norm(best->center - det.center);
+        }
+    }
+}
+
+DetectionScheduler::DetectionScheduler(int maxInterval, bool adaptive)
+    : maxInterval_(std::max(maxInterval, 1))
+    , adaptive_(adaptive)
+    , interval_(std::max(maxInterval, 1))
+    , framesSinceDetection_(-1)
+    , smoothedMotion_(0.0f)
+    , detectedFrames_(0)
+    , predictedFrames_(0)
+{
+}
+
+bool DetectionScheduler::shouldDetect() {
+    if (framesSinceDetection_ < 0 || framesSinceDetection_ + 1 >= interval_) {
+        framesSinceDetection_ = 0;
+        detectedFrames_++;
+        return true;
+    }
+    
+    framesSinceDetection_++;
+    predictedFrames_++;
+    return false;
+}
+
+void DetectionScheduler::reportMotion(float motion) {
+    smoothedMotion_ += kMotionSmoothing * (motion - smoothedMotion_);
+    if (!adaptive_) {
+        return;
+    }
+    
+    // 两次检测之间的累计位移不超过预算：N = 预算 / 每帧位移
+    int interval = static_cast<int>(kDriftBudget / std::max(smoothedMotion_, 1e-3f));
+    interval_ = std::min(std::max(interval, 1), maxInterval_);
+}
+
+} // namespace FootballAnalytics
@@ -0,0 +1,98 @@
+#include "RealtimeScheduler.h"
+#include <algorithm>
+#include <thread>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr double kSmoothing = 0.2;          // 处理耗时指数平滑系数
+constexpr int kMaxConsecutiveDrops = 3;     // 连续丢帧上限，之后至少降级处理一帧
+
+} // namespace
+
+double RealtimeStats::latencyPercentile(double p) const {
+    if (latencyMs.empty()) {
+        return 0.0;
+    }
+    
+    std::vector<float> sorted = latencyMs;
+    size_t k = static_cast<size_t>(std::min(std::max(p, 0.0), 100.0) / 100.0 * (sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+RealtimeScheduler::RealtimeScheduler(double fps, double deadlineFrames, bool paceToSource)
+    : periodMs_(1000.0 / (fps > 0.0 ? fps : 25.0))
+    , deadlineMs_(periodMs_ * std::max(deadlineFrames, 0.1))
+    , paceToSource_(paceToSource)
+    , action_(FrameAction::Process)
+    , fullCostMs_(-1.0)
+    , degradedCostMs_(-1.0)
+    , consecutiveDrops_(0)
+{
+    start();
+}
+
+void RealtimeScheduler::start() {
+    startTime_ = Clock::now();
+}
+
+FrameAction RealtimeScheduler::beginFrame(int frameIndex) {
+    stats_.frames++;
+    arrival_ = startTime_ + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(frameIndex * periodMs_));
+    
+    // 快于实时：等待帧到达（文件回放模拟直播源）
+    Clock::time_point now = Clock::now();
+    if (paceToSource_ && now < arrival_) {
+        std::this_thread::sleep_until(arrival_);
+        now = Clock::now();
+    }
+    
+    // 根据距截止时间的剩余时间与近期耗时选择处理方式；未测量过的方式视为来得及
+    double slackMs = deadlineMs_ - elapsedMs(arrival_, now);
+    if (fullCostMs_ < 0.0 || slackMs >= fullCostMs_) {
+        action_ = FrameAction::Process;
+    } else if (degradedCostMs_ < 0.0 || slackMs >= degradedCostMs_ ||
+               consecutiveDrops_ >= kMaxConsecutiveDrops) {
+        action_ = FrameAction::Degrade;
+    } else {
+        action_ = FrameAction::Drop;
+    }
+    
+    if (action_ == FrameAction::Drop) {
+        consecutiveDrops_++;
+        stats_.dropped++;
+    } else {
+        consecutiveDrops_ = 0;
+        processStart_ = now;
+    }
+    
+    return action_;
+}
+
+void RealtimeScheduler::endFrame() {
+    if (action_ == FrameAction::Drop) {
+        return;
+    }
+    
+    Clock::time_point now = Clock::now();
+    double costMs = elapsedMs(processStart_, now);
+    double latencyMs = elapsedMs(arrival_, now);
+    
+    double& smoothed = (action_ == FrameAction::Process) ? fullCostMs_ : degradedCostMs_;
+    smoothed = smoothed < 0.0 ? costMs : (1.0 - kSmoothing) * smoothed + kSmoothing * costMs;
+    
+    if (action_ == FrameAction::Process) {
+        stats_.processed++;
+    } else {
+        stats_.degraded++;
+    }
+    if (latencyMs > deadlineMs_) {
+        stats_.deadlineMisses++;
+    }
+    stats_.latencyMs.push_back(static_cast<float>(latencyMs));
+}
+
+} // namespace FootballAnalytics
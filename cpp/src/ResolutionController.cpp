@@ -0,0 +1,99 @@
+#include "ResolutionController.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr double kSmoothing = 0.2;          // 耗时指数平滑系数
+constexpr double kUpgradeHeadroom = 0.85;   // 预计耗时低于预算的该比例才允许升档
+
+} // namespace
+
+ResolutionController::ResolutionController(const std::vector<int>& sizes, double budgetMs,
+                                           int initialSize, int upgradeFrames)
+    : sizes_(sizes)
+    , overheadMs_(-1.0)
+    , budgetMs_(budgetMs)
+    , upgradeFrames_(std::max(upgradeFrames, 1))
+    , current_(0)
+    , headroomFrames_(0)
+{
+    sizes_.erase(std::remove_if(sizes_.begin(), sizes_.end(), [](int s) { return s <= 0; }), sizes_.end());
+    if (sizes_.empty()) {
+        sizes_.push_back(initialSize);
+    }
+    std::sort(sizes_.begin(), sizes_.end());
+    sizes_.erase(std::unique(sizes_.begin(), sizes_.end()), sizes_.end());
+    
+    detectMs_.assign(sizes_.size(), -1.0);
+    for (size_t i = 1; i < sizes_.size(); i++) {
+        if (std::abs(sizes_[i] - initialSize) < std::abs(sizes_[current_] - initialSize)) {
+            current_ = static_cast<int>(i);
+        }
+    }
+    
+    stats_.sizes = sizes_;
+    stats_.frames.assign(sizes_.size(), 0);
+}
+
+double ResolutionController::estimateDetectMs(int index) const {
+    if (detectMs_[index] >= 0.0) {
+        return detectMs_[index];
+    }
+    
+    // 由最近的已测档位按输入面积比例估计（卷积网络的计算量与像素数近似成正比）
+    int nearest = -1;
+    for (int i = 0; i < static_cast<int>(sizes_.size()); i++) {
+        if (detectMs_[i] >= 0.0 && (nearest < 0 || std::abs(i - index) < std::abs(nearest - index))) {
+            nearest = i;
+        }
+    }
+    if (nearest < 0) {
+        return 0.0;
+    }
+    double ratio = static_cast<double>(sizes_[index]) / sizes_[nearest];
+    return detectMs_[nearest] * ratio * ratio;
+}
+
+void ResolutionController::report(double detectMs, double frameMs) {
+    stats_.frames[current_]++;
+    if (frameMs > budgetMs_) {
+        stats_.overBudgetFrames++;
+    }
+    
+    // 隔帧检测、运动门控等未运行检测的帧只更新其余阶段耗时
+    double overhead = std::max(frameMs - detectMs, 0.0);
+    overheadMs_ = overheadMs_ < 0.0 ? overhead : (1.0 - kSmoothing) * overheadMs_ + kSmoothing * overhead;
+    if (detectMs > 0.0) {
+        double& smoothed = detectMs_[current_];
+        smoothed = smoothed < 0.0 ? detectMs : (1.0 - kSmoothing) * smoothed + kSmoothing * detectMs;
+    }
+    if (detectMs_[current_] < 0.0) {
+        return;
+    }
+    
+    // 超出预算：立即降一档
+    if (overheadMs_ + detectMs_[current_] > budgetMs_ && current_ > 0) {
+        current_--;
+        headroomFrames_ = 0;
+        stats_.downgrades++;
+        return;
+    }
+    
+    // 更高一档预计仍在预算内并持续若干帧：升一档
+    if (current_ + 1 < static_cast<int>(sizes_.size()) &&
+        overheadMs_ + estimateDetectMs(current_ + 1) <= kUpgradeHeadroom * budgetMs_) {
+        if (++headroomFrames_ >= upgradeFrames_) {
+            current_++;
+            headroomFrames_ = 0;
+            stats_.upgrades++;
+        }
+    } else {
+        headroomFrames_ = 0;
+    }
+}
+
+} // namespace FootballAnalytics
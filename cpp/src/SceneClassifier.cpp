@@ -0,0 +1,125 @@
+#include "SceneClassifier.h"
+#include <algorithm>
+#include <chrono>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr int kThumbWidth = 96;       // 缩略图宽度（高度按图像比例）
+constexpr int kHueBins = 16;          // 镜头切换直方图的色调分箱
+constexpr int kSaturationBins = 8;    // 镜头切换直方图的饱和度分箱
+
+// 草地HSV范围（OpenCV色调0~180），与球场掩码一致
+const cv::Scalar kGrassLower(30, 40, 40);
+const cv::Scalar kGrassUpper(90, 255, 255);
+
+} // namespace
+
+SceneClassifier::SceneClassifier(float minGrassRatio, float minEdgeDensity,
+                                 float cutThreshold, int minSceneFrames)
+    : minGrassRatio_(minGrassRatio)
+    , minEdgeDensity_(minEdgeDensity)
+    , cutThreshold_(cutThreshold)
+    , minSceneFrames_(std::max(minSceneFrames, 1))
+    , candidateType_(SceneType::Tactical)
+    , candidateFrames_(0)
+    , hasPrevious_(false)
+{
+}
+
+void SceneClassifier::reset() {
+    info_ = SceneInfo();
+    candidateType_ = SceneType::Tactical;
+    candidateFrames_ = 0;
+    hasPrevious_ = false;
+}
+
+const char* SceneClassifier::typeName(SceneType type) {
+    switch (type) {
+        case SceneType::Tactical: return "tactical";
+        case SceneType::CloseUp:  return "closeup";
+        case SceneType::NonPitch: return "nonpitch";
+    }
+    return "unknown";
+}
+
+SceneType SceneClassifier::rawType() const {
+    if (info_.grassRatio < minGrassRatio_) {
+        return SceneType::NonPitch;
+    }
+    return info_.edgeDensity < minEdgeDensity_ ? SceneType::CloseUp : SceneType::Tactical;
+}
+
+const SceneInfo& SceneClassifier::classify(const cv::Mat& frame) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    info_.cut = false;
+    if (frame.empty()) {
+        return info_;
+    }
+    
+    int thumbHeight = std::max(1, cvRound(static_cast<double>(kThumbWidth) * frame.rows / frame.cols));
+    cv::resize(frame, thumb_, cv::Size(kThumbWidth, thumbHeight), 0, 0, cv::INTER_AREA);
+    cv::cvtColor(thumb_, hsv_, cv::COLOR_BGR2HSV);
+    
+    // 1. 草地比例
+    cv::inRange(hsv_, kGrassLower, kGrassUpper, grass_);
+    int grassPixels = cv::countNonZero(grass_);
+    info_.grassRatio = static_cast<float>(grassPixels) / grass_.total();
+    
+    // 2. 草地区域（含边界）内的边缘密度：远景中球场线和球员产生大量小尺度边缘
+    cv::cvtColor(thumb_, gray_, cv::COLOR_BGR2GRAY);
+    cv::Canny(gray_, edges_, 50, 150);
+    cv::dilate(grass_, grass_, cv::Mat());
+    cv::bitwise_and(edges_, grass_, edges_);
+    info_.edgeDensity = grassPixels > 0 ? static_cast<float>(cv::countNonZero(edges_)) / grassPixels : 0.0f;
+    
+    // 3. 镜头切换：H-S直方图距离
+    const int channels[] = {0, 1};
+    const int histSize[] = {kHueBins, kSaturationBins};
+    const float hueRange[] = {0, 180};
+    const float saturationRange[] = {0, 256};
+    const float* ranges[] = {hueRange, saturationRange};
+    cv::calcHist(&hsv_, 1, channels, cv::Mat(), hist_, 2, histSize, ranges);
+    cv::normalize(hist_, hist_, 1.0, 0.0, cv::NORM_L1);
+    
+    if (hasPrevious_) {
+        info_.histDistance = static_cast<float>(cv::compareHist(hist_, prevHist_, cv::HISTCMP_BHATTACHARYYA));
+        info_.cut = info_.histDistance > cutThreshold_;
+    }
+    cv::swap(hist_, prevHist_);
+    
+    // 4. 类型平滑：切换帧立即采用新类型，否则需连续minSceneFrames_帧一致
+    SceneType type = rawType();
+    if (!hasPrevious_ || info_.cut) {
+        info_.type = type;
+        candidateFrames_ = 0;
+    } else if (type != info_.type) {
+        candidateFrames_ = (type == candidateType_) ? candidateFrames_ + 1 : 1;
+        candidateType_ = type;
+        if (candidateFrames_ >= minSceneFrames_) {
+            info_.type = type;
+            candidateFrames_ = 0;
+        }
+    } else {
+        candidateFrames_ = 0;
+    }
+    hasPrevious_ = true;
+    
+    stats_.frames++;
+    if (info_.cut) {
+        stats_.cuts++;
+    }
+    if (info_.type == SceneType::CloseUp) {
+        stats_.closeUpFrames++;
+    } else if (info_.type == SceneType::NonPitch) {
+        stats_.nonPitchFrames++;
+    }
+    stats_.totalMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    
+    return info_;
+}
+
+} // namespace FootballAnalytics
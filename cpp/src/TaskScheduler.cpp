@@ -0,0 +1,261 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr int kChunksPerThread = 4;    // parallelFor 每个线程划分的任务数，负载不均时可被窃取
+constexpr int kIdleSpins = 64;         // 工作线程休眠前的空转次数
+
+thread_local const TaskScheduler* tlsScheduler = nullptr;
+thread_local int tlsWorkerIndex = -1;
+
+} // namespace
+
+TaskScheduler::TaskScheduler(int numThreads, const std::vector<int>& cores)
+    : queued_(0)
+    , nextWorker_(0)
+    , stop_(false)
+    , tasksRun_(0)
+    , tasksStolen_(0)
+{
+    for (int i = 0; i < numThreads; i++) {
+        workers_.emplace_back(new Worker());
+    }
+    
+    // 先创建全部队列再启动线程（窃取时会访问其他线程的队列）
+    for (size_t i = 0; i < workers_.size(); i++) {
+        int core = cores.empty() ? -1 : cores[i % cores.size()];
+        workers_[i]->thread = std::thread(&TaskScheduler::workerLoop, this, static_cast<int>(i), core);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    stop_ = true;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCond_.notify_all();
+    
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+TaskSchedulerStats TaskScheduler::getStats() const {
+    TaskSchedulerStats stats;
+    stats.tasks = tasksRun_.load();
+    stats.stolen = tasksStolen_.load();
+    return stats;
+}
+
+int TaskScheduler::currentWorker() const {
+    return tlsScheduler == this ? tlsWorkerIndex : -1;
+}
+
+void TaskScheduler::submit(Task task) {
+    int self = currentWorker();
+    Worker& worker = *workers_[self >= 0 ? self : nextWorker_++ % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    queued_++;
+    
+    // 持锁后再通知，避免工作线程检查完条件、尚未进入等待时错过唤醒
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCond_.notify_one();
+}
+
+bool TaskScheduler::runOne(int self) {
+    Task task;
+    bool found = false;
+    bool stolen = false;
+    
+    // 本线程队尾（最近提交的任务）
+    if (self >= 0) {
+        Worker& own = *workers_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    
+    // 从其他线程队首窃取
+    const size_t numWorkers = workers_.size();
+    size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : nextWorker_.load();
+    for (size_t k = 0; !found && k < numWorkers; k++) {
+        size_t victim = (start + k) % numWorkers;
+        if (static_cast<int>(victim) == self) {
+            continue;
+        }
+        Worker& other = *workers_[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            found = true;
+            stolen = true;
+        }
+    }
+    
+    if (!found) {
+        return false;
+    }
+    
+    queued_--;
+    tasksRun_++;
+    if (stolen) {
+        tasksStolen_++;
+    }
+    task.group->execute(task.func);
+    return true;
+}
+
+void TaskScheduler::workerLoop(int index, int core) {
+    tlsScheduler = this;
+    tlsWorkerIndex = index;
+    if (core >= 0) {
+        pinCurrentThread({core});
+    }
+    
+    int idle = 0;
+    while (!stop_) {
+        if (runOne(index)) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < kIdleSpins) {
+            std::this_thread::yield();
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCond_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        idle = 0;
+    }
+}
+
+void TaskScheduler::parallelFor(const cv::Range& range, const std::function<void(const cv::Range&)>& body,
+                                int grain) {
+    int length = range.end - range.start;
+    if (length <= 0) {
+        return;
+    }
+    
+    grain = std::max(grain, 1);
+    int chunks = std::min((getNumThreads() + 1) * kChunksPerThread, (length + grain - 1) / grain);
+    if (workers_.empty() || chunks <= 1) {
+        body(range);
+        return;
+    }
+    
+    int chunkSize = (length + chunks - 1) / chunks;
+    TaskGroup group(this);
+    for (int start = range.start + chunkSize; start < range.end; start += chunkSize) {
+        cv::Range sub(start, std::min(start + chunkSize, range.end));
+        group.run([&body, sub] { body(sub); });
+    }
+    
+    // 第一块在调用线程中执行，之后参与执行其余任务直到全部完成
+    body(cv::Range(range.start, std::min(range.start + chunkSize, range.end)));
+    group.wait();
+}
+
+bool TaskScheduler::pinCurrentThread(const std::vector<int>& cores) {
+    if (cores.empty()) {
+        return false;
+    }
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores) {
+        if (core >= 0 && core < CPU_SETSIZE) {
+            CPU_SET(core, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int core : cores) {
+        if (core >= 0 && core < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+            mask |= static_cast<DWORD_PTR>(1) << core;
+        }
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+}
+
+TaskGroup::TaskGroup(TaskScheduler* scheduler)
+    : scheduler_(scheduler != nullptr && scheduler->getNumThreads() > 0 ? scheduler : nullptr)
+    , pending_(0)
+{
+}
+
+TaskGroup::~TaskGroup() {
+    // 未调用wait（如异常退出）时仍需等待，任务引用了本对象
+    while (pending_.load() > 0) {
+        if (!scheduler_->runOne(scheduler_->currentWorker())) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskGroup::run(std::function<void()> func) {
+    pending_++;
+    if (scheduler_ == nullptr) {
+        execute(func);
+        return;
+    }
+    scheduler_->submit({std::move(func), this});
+}
+
+void TaskGroup::wait() {
+    while (pending_.load() > 0) {
+        if (!scheduler_->runOne(scheduler_->currentWorker())) {
+            std::this_thread::yield();
+        }
+    }
+    
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        std::swap(error, error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::execute(const std::function<void()>& func) {
+    try {
+        func();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+    // 最后一步：计数归零后等待方可能立即销毁本对象
+    pending_--;
+}
+
+} // namespace FootballAnalytics
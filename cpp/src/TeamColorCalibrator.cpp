@@ -0,0 +1,338 @@
+#include "TeamColorCalibrator.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace FootballAnalytics {
+
+namespace {
+
+constexpr int kMaxClusters = 16;          // 增量聚类的簇数上限
+constexpr float kClusterRadius = 18.0f;   // 样本并入已有簇的LAB距离阈值（8位LAB）
+constexpr float kMergeRadius = 12.0f;     // 簇中心过近时合并
+constexpr float kTeamSeparation = 25.0f;  // 两支球队主颜色的最小LAB距离
+constexpr float kGrassDistance = 20.0f;   // 与本帧实测草地颜色的LAB距离低于该值视为草地
+constexpr float kMinGrassShare = 0.2f;    // 缩略图草地像素比例低于该值时不是比赛画面，跳过该帧
+constexpr int kThumbnailWidth = 160;      // 测量草地颜色的缩略图宽度
+constexpr float kOutlierMinShare = 0.02f; // 离群簇作为守门员颜色所需的最小样本占比
+constexpr int kMinCropSide = 8;           // 过小的球员框不参与标定
+constexpr int kMergeEveryFrames = 10;     // 每处理若干帧整理一次簇
+constexpr int kMaxFramesFactor = 4;       // 缺省最多查看的帧数（标定帧数的倍数）
+
+// 草地色调范围（HSV），与 PitchMask / SceneClassifier 一致
+const cv::Scalar kGrassLower(30, 40, 40);
+const cv::Scalar kGrassUpper(90, 255, 255);
+
+inline float labDistance(const cv::Vec3f& a, const cv::Vec3f& b) {
+    cv::Vec3f d = a - b;
+    return std::sqrt(d.dot(d));
+}
+
+cv::Vec3f rgbToLab8(const cv::Scalar& rgb) {
+    cv::Mat pixel(1, 1, CV_8UC3, cv::Scalar(cv::saturate_cast<uchar>(rgb[0]),
+                                            cv::saturate_cast<uchar>(rgb[1]),
+                                            cv::saturate_cast<uchar>(rgb[2])));
+    cv::Mat lab;
+    cv::cvtColor(pixel, lab, cv::COLOR_RGB2Lab);
+    cv::Vec3b v = lab.at<cv::Vec3b>(0, 0);
+    return cv::Vec3f(v[0], v[1], v[2]);
+}
+
+cv::Scalar lab8ToRgb(const cv::Vec3f& lab) {
+    cv::Mat pixel(1, 1, CV_8UC3, cv::Scalar(cv::saturate_cast<uchar>(lab[0]),
+                                            cv::saturate_cast<uchar>(lab[1]),
+                                            cv::saturate_cast<uchar>(lab[2])));
+    cv::Mat rgb;
+    cv::cvtColor(pixel, rgb, cv::COLOR_Lab2RGB);
+    cv::Vec3b v = rgb.at<cv::Vec3b>(0, 0);
+    return cv::Scalar(v[0], v[1], v[2]);
+}
+
+} // namespace
+
+TeamColorCalibrator::TeamColorCalibrator(int calibrationFrames, int maxFrames, int maxPendingFrames)
+    : calibrationFrames_(std::max(calibrationFrames, 1))
+    , maxFrames_(maxFrames > 0 ? std::min(maxFrames, calibrationFrames_ * kMaxFramesFactor)
+                               : calibrationFrames_ * kMaxFramesFactor)
+    , maxPendingFrames_(std::max(maxPendingFrames, 1))
+    , seenFrames_(0)
+    , lastSubmitted_(false)
+    , stop_(false)
+    , ready_(false)
+    , finished_(false)
+    , paletteExtractor_(3)
+{
+    clusters_.reserve(kMaxClusters + 1);
+    worker_ = std::thread(&TeamColorCalibrator::workerLoop, this);
+}
+
+TeamColorCalibrator::~TeamColorCalibrator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void TeamColorCalibrator::addFrame(const cv::Mat& frame, const std::vector<Detection>& playerDetections) {
+    if (!isCollecting() || frame.empty()) {
+        return;
+    }
+    
+    // 查看的帧数到达上限时，这一帧作为最后一帧触发标定完成
+    seenFrames_++;
+    bool last = seenFrames_ >= maxFrames_;
+    
+    // 只拷贝球员小图，颜色分析在后台线程进行
+    FrameSamples samples;
+    samples.last = last;
+    samples.crops.reserve(playerDetections.size());
+    
+    cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+    for (const auto& det : playerDetections) {
+        cv::Rect box = det.bbox & frameRect;
+        if (box.width < kMinCropSide || box.height < kMinCropSide) {
+            continue;
+        }
+        samples.crops.push_back(frame(box).clone());
+    }
+    
+    // 没有球员小图的帧（片头、特写）不送入后台
+    if (samples.crops.empty() && !last) {
+        return;
+    }
+    
+    // 缩略图用于在后台测量本帧的草地颜色
+    if (!samples.crops.empty()) {
+        int thumbHeight = std::max(1, frame.rows * kThumbnailWidth / std::max(frame.cols, 1));
+        cv::resize(frame, samples.thumbnail, cv::Size(kThumbnailWidth, thumbHeight), 0, 0, cv::INTER_AREA);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 队列已满时丢弃普通帧（最后一帧必须送达以触发标定完成）
+        if (!last && static_cast<int>(pending_.size()) >= maxPendingFrames_) {
+            return;
+        }
+        pending_.push_back(std::move(samples));
+        lastSubmitted_ = last;
+    }
+    cv_.notify_one();
+}
+
+void TeamColorCalibrator::finish() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!lastSubmitted_ && !finished_.load()) {
+        FrameSamples samples;
+        samples.last = true;
+        pending_.push_back(std::move(samples));
+        lastSubmitted_ = true;
+        cv_.notify_one();
+    }
+    finishedCv_.wait(lock, [this] { return finished_.load(); });
+}
+
+void TeamColorCalibrator::markFinished() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_.store(true);
+    }
+    finishedCv_.notify_all();
+}
+
+bool TeamColorCalibrator::getTeamColors(const std::string& team1Name, const std::string& team2Name,
+                                        TeamColorInfo& team1, TeamColorInfo& team2) const {
+    if (!ready_.load()) {
+        return false;
+    }
+    
+    team1 = TeamColorInfo(team1Name, teamColors_[0], goalkeeperColors_[0]);
+    team2 = TeamColorInfo(team2Name, teamColors_[1], goalkeeperColors_[1]);
+    return true;
+}
+
+bool TeamColorCalibrator::measureGrass(const cv::Mat& thumbnail, cv::Vec3f& grassLab) {
+    if (thumbnail.empty()) {
+        return false;
+    }
+    
+    cv::cvtColor(thumbnail, hsv_, cv::COLOR_BGR2HSV);
+    cv::inRange(hsv_, kGrassLower, kGrassUpper, grass_);
+    int grassPixels = cv::countNonZero(grass_);
+    if (grassPixels < kMinGrassShare * grass_.total()) {
+        return false;
+    }
+    
+    cv::Scalar bgr = cv::mean(thumbnail, grass_);
+    grassLab = rgbToLab8(cv::Scalar(bgr[2], bgr[1], bgr[0]));
+    return true;
+}
+
+void TeamColorCalibrator::workerLoop() {
+    int processedFrames = 0;
+    int sampledFrames = 0;     // 提供了至少一个样本的帧数
+    
+    while (true) {
+        FrameSamples samples;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (stop_) {
+                return;
+            }
+            samples = std::move(pending_.front());
+            pending_.pop_front();
+        }
+        
+        // 按本帧实测的草地颜色区分草地与球衣（绿色球衣与草地的明度/饱和度通常不同）；
+        // 测不到草地的帧不是比赛画面，整帧跳过
+        bool sampled = false;
+        cv::Vec3f grassLab;
+        bool hasGrass = measureGrass(samples.thumbnail, grassLab);
+        for (size_t i = 0; hasGrass && i < samples.crops.size(); i++) {
+            const cv::Mat& crop = samples.crops[i];
+            std::vector<cv::Scalar> palette = paletteExtractor_.extractColorPalette(
+                crop, cv::Rect(0, 0, crop.cols, crop.rows));
+            
+            // 取像素最多的非草地颜色作为球衣颜色；全部接近草地时丢弃该样本
+            for (const auto& color : palette) {
+                cv::Vec3f lab = rgbToLab8(color);
+                if (labDistance(lab, grassLab) >= kGrassDistance) {
+                    addSample(lab);
+                    sampled = true;
+                    break;
+                }
+            }
+        }
+        
+        if (++processedFrames % kMergeEveryFrames == 0) {
+            mergeClusters();
+        }
+        
+        // 只有提供了样本的帧计入标定帧数；提前结束时用已收集的样本标定
+        if (sampled) {
+            sampledFrames++;
+        }
+        if (samples.last || sampledFrames >= calibrationFrames_) {
+            mergeClusters();
+            if (finalize()) {
+                ready_.store(true);
+            } else {
+                std::cerr << "Team color calibration failed after " << sampledFrames
+                          << " frames: could not separate two teams" << std::endl;
+            }
+            markFinished();
+            return;
+        }
+    }
+}
+
+void TeamColorCalibrator::addSample(const cv::Vec3f& lab) {
+    // 找最近的簇，距离足够近则增量更新中心
+    int best = -1;
+    float bestDist = std::numeric_limits<float>::max();
+    for (size_t c = 0; c < clusters_.size(); c++) {
+        float dist = labDistance(clusters_[c].lab, lab);
+        if (dist < bestDist) {
+            bestDist = dist;
+            best = static_cast<int>(c);
+        }
+    }
+    
+    if (best < 0 || (bestDist > kClusterRadius && static_cast<int>(clusters_.size()) < kMaxClusters)) {
+        clusters_.push_back({lab, 1});
+        return;
+    }
+    
+    // 簇数已满时并入最近的簇
+    ColorCluster& cluster = clusters_[best];
+    cluster.count++;
+    cluster.lab += (lab - cluster.lab) * (1.0f / cluster.count);
+}
+
+void TeamColorCalibrator::mergeClusters() {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < clusters_.size() && !merged; i++) {
+            for (size_t j = i + 1; j < clusters_.size(); j++) {
+                if (labDistance(clusters_[i].lab, clusters_[j].lab) < kMergeRadius) {
+                    int total = clusters_[i].count + clusters_[j].count;
+                    clusters_[i].lab = (clusters_[i].lab * static_cast<float>(clusters_[i].count) +
+                                        clusters_[j].lab * static_cast<float>(clusters_[j].count)) *
+                                       (1.0f / total);
+                    clusters_[i].count = total;
+                    clusters_.erase(clusters_.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool TeamColorCalibrator::finalize() {
+    std::sort(clusters_.begin(), clusters_.end(),
+             [](const ColorCluster& a, const ColorCluster& b) { return a.count > b.count; });
+    
+    if (clusters_.size() < 2) {
+        return false;
+    }
+    
+    // 最大的簇为第一支球队，与其足够远的最大簇为第二支球队
+    int team2 = -1;
+    for (size_t c = 1; c < clusters_.size(); c++) {
+        if (labDistance(clusters_[c].lab, clusters_[0].lab) >= kTeamSeparation) {
+            team2 = static_cast<int>(c);
+            break;
+        }
+    }
+    if (team2 < 0) {
+        return false;
+    }
+    
+    int totalSamples = 0;
+    for (const auto& cluster : clusters_) {
+        totalSamples += cluster.count;
+    }
+    
+    // 其余足够大且远离两队的簇视为离群颜色（守门员/裁判）。单凭颜色无法判断守门员属于哪一队，
+    // 离群颜色只输出不分配，两队的守门员参考色使用本队球员颜色
+    const cv::Vec3f teamLab[2] = {clusters_[0].lab, clusters_[team2].lab};
+    std::vector<cv::Scalar> outliers;
+    
+    for (size_t c = 1; c < clusters_.size(); c++) {
+        if (static_cast<int>(c) == team2 ||
+            clusters_[c].count < kOutlierMinShare * totalSamples) {
+            continue;
+        }
+        if (labDistance(clusters_[c].lab, teamLab[0]) < kTeamSeparation ||
+            labDistance(clusters_[c].lab, teamLab[1]) < kTeamSeparation) {
+            continue;
+        }
+        outliers.push_back(lab8ToRgb(clusters_[c].lab));
+    }
+    
+    for (int t = 0; t < 2; t++) {
+        teamColors_[t] = lab8ToRgb(teamLab[t]);
+        goalkeeperColors_[t] = teamColors_[t];
+    }
+    
+    std::cout << "Team colors calibrated from " << totalSamples << " player crops ("
+              << clusters_.size() << " color clusters, " << outliers.size() << " outlier colors)" << std::endl;
+    if (!outliers.empty()) {
+        std::cout << "Outlier colors (goalkeepers/referees, not assigned to a team):";
+        for (const auto& rgb : outliers) {
+            std::cout << " RGB(" << static_cast<int>(rgb[0]) << "," << static_cast<int>(rgb[1]) << ","
+                      << static_cast<int>(rgb[2]) << ")";
+        }
+        std::cout << std::endl;
+    }
+    return true;
+}
+
+} // namespace FootballAnalytics
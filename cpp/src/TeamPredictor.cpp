@@ -1,13 +1,162 @@
 #include "TeamPredictor.h"
+#include "PitchMask.h"
+#include "TaskScheduler.h"
+#include "SimdUtils.h"
 #include <iostream>
 #include <algorithm>
-#include <map>
+#include <chrono>
+#include <cmath>
 
 namespace FootballAnalytics {
 
+namespace {
+
+constexpr int kLabLutBits = 5;                       // RGB每通道量化位数
+constexpr int kLabLutShift = 8 - kLabLutBits;
+constexpr int kLabLutLevels = 1 << kLabLutBits;
+
+/**
+ * @brief 量化RGB -> LAB查找表（8位LAB，与cv::COLOR_RGB2Lab同一尺度），首次使用时构建
+ * 
+ * 每个量化格取中心值的LAB，同一格内的颜色得到相同结果（相对精确值有量化误差）
+ */
+const std::vector<cv::Vec3b>& labLookupTable() {
+    static const std::vector<cv::Vec3b> table = [] {
+        const int numEntries = kLabLutLevels * kLabLutLevels * kLabLutLevels;
+        cv::Mat rgb(1, numEntries, CV_8UC3);
+        
+        // 每个量化格取中心值
+        int idx = 0;
+        for (int r = 0; r < kLabLutLevels; r++) {
+            for (int g = 0; g < kLabLutLevels; g++) {
+                for (int b = 0; b < kLabLutLevels; b++) {
+                    rgb.at<cv::Vec3b>(0, idx++) = cv::Vec3b(
+                        static_cast<uchar>((r << kLabLutShift) + (1 << (kLabLutShift - 1))),
+                        static_cast<uchar>((g << kLabLutShift) + (1 << (kLabLutShift - 1))),
+                        static_cast<uchar>((b << kLabLutShift) + (1 << (kLabLutShift - 1))));
+                }
+            }
+        }
+        
+        cv::Mat lab;
+        cv::cvtColor(rgb, lab, cv::COLOR_RGB2Lab);
+        return std::vector<cv::Vec3b>(lab.begin<cv::Vec3b>(), lab.end<cv::Vec3b>());
+    }();
+    
+    return table;
+}
+
+inline const cv::Vec3b& lookupLab(const cv::Scalar& rgb) {
+    int r = cv::saturate_cast<uchar>(rgb[0]) >> kLabLutShift;
+    int g = cv::saturate_cast<uchar>(rgb[1]) >> kLabLutShift;
+    int b = cv::saturate_cast<uchar>(rgb[2]) >> kLabLutShift;
+    return labLookupTable()[(r << (2 * kLabLutBits)) | (g << kLabLutBits) | b];
+}
+
+/**
+ * @brief 批量最近颜色搜索：nearest[i] = argmin_r |color[i] - ref[r]|²
+ * 
+ * 三个分量按SoA存放，一次处理多个颜色；距离相同时取较小的参考色索引。
+ * 用于调色板颜色与球队参考色（LAB）的匹配，以及直方图提取中样本到聚类中心（RGB）的分配
+ */
+void nearestReferenceKernel(const float* L, const float* A, const float* B, size_t count,
+                            const float* refL, const float* refA, const float* refB,
+                            int numRefs, float* nearest) {
+    size_t i = 0;
+    
+#if FA_SIMD_ENABLED
+    const size_t lanes = static_cast<size_t>(simd::lanesF32());
+    
+    for (; i + lanes <= count; i += lanes) {
+        cv::v_float32 vL = cv::vx_load(L + i);
+        cv::v_float32 vA = cv::vx_load(A + i);
+        cv::v_float32 vB = cv::vx_load(B + i);
+        
+        cv::v_float32 best = cv::vx_setall_f32(std::numeric_limits<float>::max());
+        cv::v_float32 bestIdx = cv::vx_setzero_f32();
+        
+        for (int r = 0; r < numRefs; r++) {
+            cv::v_float32 dL = simd::sub(vL, cv::vx_setall_f32(refL[r]));
+            cv::v_float32 dA = simd::sub(vA, cv::vx_setall_f32(refA[r]));
+            cv::v_float32 dB = simd::sub(vB, cv::vx_setall_f32(refB[r]));
+            cv::v_float32 dist = cv::v_fma(dL, dL, cv::v_fma(dA, dA, simd::mul(dB, dB)));
+            
+            cv::v_float32 closer = simd::lt(dist, best);
+            best = cv::v_select(closer, dist, best);
+            bestIdx = cv::v_select(closer, cv::vx_setall_f32(static_cast<float>(r)), bestIdx);
+        }
+        
+        cv::v_store(nearest + i, bestIdx);
+    }
+#endif
+    
+    for (; i < count; i++) {
+        float best = std::numeric_limits<float>::max();
+        int bestIdx = 0;
+        
+        for (int r = 0; r < numRefs; r++) {
+            float dL = L[i] - refL[r];
+            float dA = A[i] - refA[r];
+            float dB = B[i] - refB[r];
+            float dist = dL * dL + dA * dA + dB * dB;
+            if (dist < best) {
+                best = dist;
+                bestIdx = r;
+            }
+        }
+        
+        nearest[i] = static_cast<float>(bestIdx);
+    }
+}
+
+/**
+ * @brief 批量计算颜色直方图的bin索引：bins[i] = (r>>shift, g>>shift, b>>shift) 拼接
+ * 
+ * 输入为0-255的整数值浮点数，乘以2的负幂后取整与移位等价
+ */
+void quantizeBinsKernel(const float* R, const float* G, const float* B, size_t count,
+                        int binBits, int* bins) {
+    size_t i = 0;
+    
+#if FA_SIMD_ENABLED
+    const size_t lanes = static_cast<size_t>(simd::lanesF32());
+    const cv::v_float32 vScale = cv::vx_setall_f32(1.0f / static_cast<float>(1 << (8 - binBits)));
+    const cv::v_float32 vLevels = cv::vx_setall_f32(static_cast<float>(1 << binBits));
+    
+    for (; i + lanes <= count; i += lanes) {
+        cv::v_float32 qR = cv::v_cvt_f32(cv::v_floor(simd::mul(cv::vx_load(R + i), vScale)));
+        cv::v_float32 qG = cv::v_cvt_f32(cv::v_floor(simd::mul(cv::vx_load(G + i), vScale)));
+        cv::v_float32 qB = cv::v_cvt_f32(cv::v_floor(simd::mul(cv::vx_load(B + i), vScale)));
+        
+        // (qR * levels + qG) * levels + qB，结果为精确整数
+        cv::v_float32 bin = cv::v_fma(cv::v_fma(qR, vLevels, qG), vLevels, qB);
+        cv::v_store(bins + i, cv::v_round(bin));
+    }
+#endif
+    
+    for (; i < count; i++) {
+        int r = static_cast<int>(R[i]) >> (8 - binBits);
+        int g = static_cast<int>(G[i]) >> (8 - binBits);
+        int b = static_cast<int>(B[i]) >> (8 - binBits);
+        bins[i] = (r << (2 * binBits)) | (g << binBits) | b;
+    }
+}
+
+} // namespace
+
 TeamPredictor::TeamPredictor(int numPaletteColors)
     : numPaletteColors_(numPaletteColors)
+    , paletteMode_(PaletteMode::Histogram)
+    , parallel_(true)
+    , pitchMask_(nullptr)
+    , taskScheduler_(nullptr)
+    , trackCacheEnabled_(false)
+    , cacheRefreshInterval_(50)
+    , cacheMinConfidence_(0.8f)
+    , frameCounter_(0)
 {
+    // 启动时构建RGB -> LAB查找表
+    labLookupTable();
 }
 
 TeamPredictor::~TeamPredictor() {
@@ -26,23 +175,36 @@ void TeamPredictor::setTeamColors(const TeamColorInfo& team1, const TeamColorInf
     referenceColors_.push_back(rgbToLab(team2.playerColor));
     referenceColors_.push_back(rgbToLab(team2.goalkeeperColor));
     
+    // SoA形式的参考色，供批量最近邻内核使用
+    refL_.clear();
+    refA_.clear();
+    refB_.clear();
+    for (const auto& lab : referenceColors_) {
+        refL_.push_back(static_cast<float>(lab[0]));
+        refA_.push_back(static_cast<float>(lab[1]));
+        refB_.push_back(static_cast<float>(lab[2]));
+    }
+    
     std::cout << "Team colors configured:" << std::endl;
     std::cout << "  Team 1: " << team1.teamName << std::endl;
     std::cout << "  Team 2: " << team2.teamName << std::endl;
 }
 
 cv::Scalar TeamPredictor::rgbToLab(const cv::Scalar& rgb) {
-    // 创建单像素图像
-    cv::Mat rgbMat(1, 1, CV_8UC3, rgb);
-    cv::Mat labMat;
-    
-    // 转换到LAB空间
-    cv::cvtColor(rgbMat, labMat, cv::COLOR_RGB2Lab);
-    
-    return labMat.at<cv::Vec3b>(0, 0);
+    // 查表（量化到每通道5位）
+    const cv::Vec3b& lab = lookupLab(rgb);
+    return cv::Scalar(lab[0], lab[1], lab[2]);
+}
+
+cv::Scalar TeamPredictor::rgbToLabExact(const cv::Scalar& rgb) {
+    cv::Mat pixel(1, 1, CV_8UC3, cv::Scalar(rgb[0], rgb[1], rgb[2]));
+    cv::Mat lab;
+    cv::cvtColor(pixel, lab, cv::COLOR_RGB2Lab);
+    const cv::Vec3b& value = lab.at<cv::Vec3b>(0, 0);
+    return cv::Scalar(value[0], value[1], value[2]);
 }
 
-float TeamPredictor::computeLabDistance(const cv::Scalar& lab1, const cv::Scalar& lab2) {
+float TeamPredictor::computeLabDistance(const cv::Scalar& lab1, const cv::Scalar& lab2) const {
     // CIE76颜色差异公式
     float dL = lab1[0] - lab2[0];
     float da = lab1[1] - lab2[1];
@@ -51,53 +213,208 @@ float TeamPredictor::computeLabDistance(const cv::Scalar& lab1, const cv::Scalar
     return std::sqrt(dL * dL + da * da + db * db);
 }
 
-std::vector<cv::Scalar> TeamPredictor::extractColorPalette(const cv::Mat& frame,
-                                                          const cv::Rect& bbox) {
-    std::vector<cv::Scalar> palette;
-    
+cv::Mat TeamPredictor::jerseyRegion(const cv::Mat& frame, const cv::Rect& bbox) const {
     // 确保边界框在图像范围内
     cv::Rect safeBbox = bbox & cv::Rect(0, 0, frame.cols, frame.rows);
     if (safeBbox.width <= 0 || safeBbox.height <= 0) {
-        return palette;
+        return cv::Mat();
     }
     
-    // 裁剪球员图像
-    cv::Mat playerImg = frame(safeBbox).clone();
-    
-    // 转换到RGB
-    cv::Mat playerRgb;
-    cv::cvtColor(playerImg, playerRgb, cv::COLOR_BGR2RGB);
-    
     // 提取中心区域（球衣区域）
-    int centerX1 = std::max(playerRgb.cols / 2 - playerRgb.cols / 5, 0);
-    int centerX2 = std::min(playerRgb.cols / 2 + playerRgb.cols / 5, playerRgb.cols);
-    int centerY1 = std::max(playerRgb.rows / 3 - playerRgb.rows / 5, 0);
-    int centerY2 = std::min(playerRgb.rows / 3 + playerRgb.rows / 5, playerRgb.rows);
+    int centerX1 = std::max(safeBbox.width / 2 - safeBbox.width / 5, 0);
+    int centerX2 = std::min(safeBbox.width / 2 + safeBbox.width / 5, safeBbox.width);
+    int centerY1 = std::max(safeBbox.height / 3 - safeBbox.height / 5, 0);
+    int centerY2 = std::min(safeBbox.height / 3 + safeBbox.height / 5, safeBbox.height);
     
-    cv::Rect centerRegion(centerX1, centerY1, centerX2 - centerX1, centerY2 - centerY1);
+    cv::Rect centerRegion(safeBbox.x + centerX1, safeBbox.y + centerY1,
+                          centerX2 - centerX1, centerY2 - centerY1);
     
     // 验证中心区域有效性
     if (centerRegion.width <= 0 || centerRegion.height <= 0) {
-        return palette;
+        return cv::Mat();
     }
     
-    cv::Mat centerImg = playerRgb(centerRegion);
+    return frame(centerRegion);
+}
+
+std::vector<cv::Scalar> TeamPredictor::extractColorPalette(const cv::Mat& frame,
+                                                          const cv::Rect& bbox) {
+    std::vector<cv::Scalar> palette;
     
-    // 检查提取的图像是否为空
-    if (centerImg.empty() || centerImg.rows == 0 || centerImg.cols == 0) {
+    // 直接在原始BGR图像的ROI视图上提取
+    cv::Mat region = jerseyRegion(frame, bbox);
+    if (region.empty()) {
         return palette;
     }
     
+    cv::Scalar colors[kMaxPaletteColors];
+    int numColors = (paletteMode_ == PaletteMode::KMeans)
+        ? extractPaletteKMeans(region, colors)
+        : extractPaletteHistogram(region, colors);
+    
+    palette.assign(colors, colors + numColors);
+    return palette;
+}
+
+int TeamPredictor::extractPaletteHistogram(const cv::Mat& region, cv::Scalar* palette) const {
+    constexpr int kMaxSamples = 256;    // 子采样上限
+    constexpr int kMaxPalette = kMaxPaletteColors;
+    constexpr int kBinBits = 3;         // 每通道量化位数（8级）
+    constexpr int kBinsPerChannel = 1 << kBinBits;
+    constexpr int kNumBins = kBinsPerChannel * kBinsPerChannel * kBinsPerChannel;
+    constexpr int kLloydIterations = 2; // 固定迭代次数
+    
+    const int clusterCount = std::min(std::max(numPaletteColors_, 1), kMaxPalette);
+    
+    // 1. 在子采样网格上收集像素（直接读取BGR图像的ROI，无拷贝）
+    int area = region.rows * region.cols;
+    int gridStep = std::max(1, static_cast<int>(std::ceil(std::sqrt(
+        static_cast<double>(area) / kMaxSamples))));
+    
+    // 按通道分开存放（SoA），供向量化内核使用
+    float sampleR[kMaxSamples], sampleG[kMaxSamples], sampleB[kMaxSamples];
+    int numSamples = 0;
+    
+    for (int y = gridStep / 2; y < region.rows && numSamples < kMaxSamples; y += gridStep) {
+        const uint8_t* row = region.ptr<uint8_t>(y);
+        for (int x = gridStep / 2; x < region.cols && numSamples < kMaxSamples; x += gridStep) {
+            // 输入为BGR
+            const uint8_t* px = row + 3 * x;
+            sampleR[numSamples] = px[2];
+            sampleG[numSamples] = px[1];
+            sampleB[numSamples] = px[0];
+            numSamples++;
+        }
+    }
+    
+    if (numSamples == 0) {
+        return 0;
+    }
+    
+    if (numSamples < clusterCount) {
+        // 样本数不足，直接计算平均颜色
+        cv::Scalar meanBgr = cv::mean(region);
+        palette[0] = cv::Scalar(meanBgr[2], meanBgr[1], meanBgr[0]);
+        return 1;
+    }
+    
+    // 2. 量化颜色直方图（bin索引批量计算，计数为散列写入）
+    int sampleBins[kMaxSamples];
+    quantizeBinsKernel(sampleR, sampleG, sampleB, numSamples, kBinBits, sampleBins);
+    
+    int binCounts[kNumBins] = {0};
+    int binSums[kNumBins][3] = {{0}};
+    
+    for (int i = 0; i < numSamples; i++) {
+        int bin = sampleBins[i];
+        binCounts[bin]++;
+        binSums[bin][0] += static_cast<int>(sampleR[i]);
+        binSums[bin][1] += static_cast<int>(sampleG[i]);
+        binSums[bin][2] += static_cast<int>(sampleB[i]);
+    }
+    
+    // 3. 选取直方图峰值作为初始中心（相邻bin视为同一颜色）
+    float centerR[kMaxPalette], centerG[kMaxPalette], centerB[kMaxPalette];
+    int peakBins[kMaxPalette];
+    int numCenters = 0;
+    
+    for (int pass = 0; pass < 2 && numCenters < clusterCount; pass++) {
+        // 第一轮要求峰值互不相邻，第二轮放宽
+        while (numCenters < clusterCount) {
+            int bestBin = -1;
+            for (int bin = 0; bin < kNumBins; bin++) {
+                if (binCounts[bin] == 0 || (bestBin >= 0 && binCounts[bin] <= binCounts[bestBin])) {
+                    continue;
+                }
+                
+                bool usable = true;
+                for (int c = 0; c < numCenters && usable; c++) {
+                    int a = peakBins[c];
+                    int d0 = std::abs((a >> (2 * kBinBits)) - (bin >> (2 * kBinBits)));
+                    int d1 = std::abs(((a >> kBinBits) & (kBinsPerChannel - 1)) -
+                                      ((bin >> kBinBits) & (kBinsPerChannel - 1)));
+                    int d2 = std::abs((a & (kBinsPerChannel - 1)) - (bin & (kBinsPerChannel - 1)));
+                    int dist = std::max(d0, std::max(d1, d2));
+                    usable = (pass == 0) ? dist > 1 : dist > 0;
+                }
+                
+                if (usable) {
+                    bestBin = bin;
+                }
+            }
+            
+            if (bestBin < 0) {
+                break;
+            }
+            
+            peakBins[numCenters] = bestBin;
+            centerR[numCenters] = static_cast<float>(binSums[bestBin][0]) / binCounts[bestBin];
+            centerG[numCenters] = static_cast<float>(binSums[bestBin][1]) / binCounts[bestBin];
+            centerB[numCenters] = static_cast<float>(binSums[bestBin][2]) / binCounts[bestBin];
+            numCenters++;
+        }
+    }
+    
+    // 4. 固定次数的Lloyd迭代（最近中心分配向量化，累加为散列写入）
+    int counts[kMaxPalette] = {0};
+    float nearest[kMaxSamples];
+    
+    for (int iter = 0; iter <= kLloydIterations; iter++) {
+        float sums[kMaxPalette][3] = {{0.0f}};
+        std::fill(counts, counts + numCenters, 0);
+        
+        nearestReferenceKernel(sampleR, sampleG, sampleB, numSamples,
+                               centerR, centerG, centerB, numCenters, nearest);
+        
+        for (int i = 0; i < numSamples; i++) {
+            int best = static_cast<int>(nearest[i]);
+            counts[best]++;
+            sums[best][0] += sampleR[i];
+            sums[best][1] += sampleG[i];
+            sums[best][2] += sampleB[i];
+        }
+        
+        // 最后一轮只统计计数，不再移动中心
+        if (iter == kLloydIterations) {
+            break;
+        }
+        
+        for (int c = 0; c < numCenters; c++) {
+            if (counts[c] > 0) {
+                centerR[c] = sums[c][0] / counts[c];
+                centerG[c] = sums[c][1] / counts[c];
+                centerB[c] = sums[c][2] / counts[c];
+            }
+        }
+    }
+    
+    // 5. 按像素数排序输出
+    int order[kMaxPalette];
+    for (int c = 0; c < numCenters; c++) {
+        order[c] = c;
+    }
+    std::sort(order, order + numCenters,
+             [&counts](int a, int b) { return counts[a] > counts[b]; });
+    
+    for (int c = 0; c < numCenters; c++) {
+        int idx = order[c];
+        palette[c] = cv::Scalar(centerR[idx], centerG[idx], centerB[idx]);
+    }
+    
+    return numCenters;
+}
+
+int TeamPredictor::extractPaletteKMeans(const cv::Mat& region, cv::Scalar* palette) const {
     // 转换为浮点数
     cv::Mat floatImg;
-    centerImg.convertTo(floatImg, CV_32F);
+    region.convertTo(floatImg, CV_32F);
     
     // 重塑为一维数组
     cv::Mat samples = floatImg.reshape(1, floatImg.rows * floatImg.cols);
     
     // 验证 samples 的维度和类型
-    if (samples.empty() || samples.dims > 2 || samples.type() != CV_32FC3) {
-        return palette;
+    if (samples.empty() || samples.dims > 2 || samples.type() != CV_32FC1) {
+        return 0;
     }
     
     // 检查样本数量是否足够进行聚类
@@ -105,87 +422,89 @@ std::vector<cv::Scalar> TeamPredictor::extractColorPalette(const cv::Mat& frame,
     if (numSamples < numPaletteColors_) {
         // 样本数不足，直接计算平均颜色
         if (numSamples > 0) {
-            cv::Scalar meanColor = cv::mean(centerImg);
-            palette.push_back(meanColor);
+            cv::Scalar meanBgr = cv::mean(region);
+            palette[0] = cv::Scalar(meanBgr[2], meanBgr[1], meanBgr[0]);
+            return 1;
         }
-        return palette;
+        return 0;
     }
     
     // 使用K-means聚类提取主要颜色
-    int clusterCount = numPaletteColors_;
+    constexpr int kMaxPalette = kMaxPaletteColors;
+    int clusterCount = std::min(numPaletteColors_, kMaxPalette);
     cv::Mat labels, centers;
     
     cv::TermCriteria criteria(cv::TermCriteria::EPS + cv::TermCriteria::MAX_ITER, 100, 0.2);
     cv::kmeans(samples, clusterCount, labels, criteria, 3, cv::KMEANS_PP_CENTERS, centers);
     
     // 统计每个簇的像素数
-    std::vector<int> counts(clusterCount, 0);
+    int counts[kMaxPalette] = {0};
     for (int i = 0; i < labels.rows; i++) {
         counts[labels.at<int>(i)]++;
     }
     
     // 按像素数排序
-    std::vector<std::pair<int, int>> sortedClusters; // (count, index)
+    int order[kMaxPalette];
     for (int i = 0; i < clusterCount; i++) {
-        sortedClusters.push_back({counts[i], i});
+        order[i] = i;
     }
-    std::sort(sortedClusters.begin(), sortedClusters.end(),
-             [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::sort(order, order + clusterCount,
+             [&counts](int a, int b) { return counts[a] > counts[b]; });
     
-    // 提取排序后的颜色
+    // 提取排序后的颜色（中心为BGR顺序，输出RGB）
     for (int i = 0; i < clusterCount; i++) {
-        int idx = sortedClusters[i].second;
-        cv::Scalar color(
-            centers.at<float>(idx, 0),
+        int idx = order[i];
+        palette[i] = cv::Scalar(
+            centers.at<float>(idx, 2),
             centers.at<float>(idx, 1),
-            centers.at<float>(idx, 2)
+            centers.at<float>(idx, 0)
         );
-        palette.push_back(color);
     }
     
-    return palette;
+    return clusterCount;
 }
 
 int TeamPredictor::predictTeamFromPalette(const std::vector<cv::Scalar>& palette) {
-    if (palette.empty() || referenceColors_.empty()) {
+    return predictTeamFromPalette(palette, referenceColors_);
+}
+
+int TeamPredictor::predictTeamFromPalette(const std::vector<cv::Scalar>& palette,
+                                          const std::vector<cv::Scalar>& references) const {
+    if (palette.empty() || references.empty()) {
         return 0; // 默认返回第一支球队
     }
     
-    // 为每种颜色投票
-    std::vector<int> votes;
+    // 为每种颜色投票（每支球队有2种颜色：球员+守门员）
+    int voteCounts[kMaxTeams] = {0};
+    int numTeams = std::min(static_cast<int>((references.size() + 1) / 2), kMaxTeams);
     
     for (const auto& color : palette) {
         // 计算与所有参考颜色的距离
         float minDistance = std::numeric_limits<float>::max();
         int closestTeam = 0;
         
-        for (size_t i = 0; i < referenceColors_.size(); i++) {
-            float distance = computeLabDistance(color, referenceColors_[i]);
+        for (size_t i = 0; i < references.size(); i++) {
+            float distance = computeLabDistance(color, references[i]);
             
             if (distance < minDistance) {
                 minDistance = distance;
-                // 每支球队有2种颜色（球员+守门员）
-                closestTeam = i / 2;
+                closestTeam = static_cast<int>(i / 2);
             }
         }
         
-        votes.push_back(closestTeam);
-    }
-    
-    // 统计投票
-    std::map<int, int> voteCounts;
-    for (int vote : votes) {
-        voteCounts[vote]++;
+        if (closestTeam < numTeams) {
+            voteCounts[closestTeam]++;
+        }
     }
     
     // 返回得票最多的球队
     int predictedTeam = 0;
     int maxVotes = 0;
     
-    for (const auto& pair : voteCounts) {
-        if (pair.second > maxVotes) {
-            maxVotes = pair.second;
-            predictedTeam = pair.first;
+    for (int team = 0; team < numTeams; team++) {
+        if (voteCounts[team] > maxVotes) {
+            maxVotes = voteCounts[team];
+            predictedTeam = team;
         }
     }
     
@@ -195,35 +514,296 @@ int TeamPredictor::predictTeamFromPalette(const std::vector<cv::Scalar>& palette
 std::vector<int> TeamPredictor::predictTeams(const cv::Mat& frame,
                                             const std::vector<Detection>& playerDetections) {
     std::vector<int> teamIds;
+    predictTeams(frame, playerDetections, teamIds);
+    return teamIds;
+}
+
+void TeamPredictor::setTrackCache(bool enable, int refreshInterval, float minConfidence) {
+    trackCacheEnabled_ = enable;
+    cacheRefreshInterval_ = std::max(1, refreshInterval);
+    cacheMinConfidence_ = minConfidence;
+    trackCache_.clear();
+}
+
+bool TeamPredictor::lookupTrackCache(int trackId, int& teamId) {
+    if (!trackCacheEnabled_ || trackId < 0) {
+        return false;
+    }
+    
+    cacheStats_.lookups++;
+    
+    auto it = trackCache_.find(trackId);
+    if (it == trackCache_.end()) {
+        return false;
+    }
+    
+    TrackTeamEntry& entry = it->second;
+    entry.lastSeenFrame = frameCounter_;
+    
+    // 观测不足、置信度低或到达稀疏刷新间隔时重新计算
+    if (entry.observations < kCacheMinObservations ||
+        entry.confidence() < cacheMinConfidence_ ||
+        frameCounter_ - entry.lastComputedFrame >= cacheRefreshInterval_) {
+        return false;
+    }
+    
+    cacheStats_.hits++;
+    teamId = entry.teamId;
+    return true;
+}
+
+int TeamPredictor::updateTrackCache(int trackId, int observedTeam) {
+    if (!trackCacheEnabled_ || trackId < 0) {
+        return observedTeam;
+    }
+    
+    TrackTeamEntry& entry = trackCache_[trackId];
+    entry.votes[observedTeam]++;
+    entry.observations++;
+    entry.lastComputedFrame = frameCounter_;
+    entry.lastSeenFrame = frameCounter_;
+    
+    // 累计投票决定球队，避免单帧误判造成的跳变
+    int best = entry.teamId >= 0 ? entry.teamId : observedTeam;
+    for (int team = 0; team < kMaxTeams; team++) {
+        if (entry.votes[team] > entry.votes[best]) {
+            best = team;
+        }
+    }
+    entry.teamId = best;
+    
+    return entry.teamId;
+}
+
+int TeamPredictor::cachedTeamOrDefault(int trackId, int defaultTeam) const {
+    if (!trackCacheEnabled_ || trackId < 0) {
+        return defaultTeam;
+    }
+    
+    auto it = trackCache_.find(trackId);
+    if (it == trackCache_.end() || it->second.teamId < 0) {
+        return defaultTeam;
+    }
+    return it->second.teamId;
+}
+
+void TeamPredictor::pruneTrackCache() {
+    // 长时间未出现的轨迹从缓存中移除
+    constexpr int kMaxUnseenFrames = 150;
+    
+    for (auto it = trackCache_.begin(); it != trackCache_.end();) {
+        if (frameCounter_ - it->second.lastSeenFrame > kMaxUnseenFrames) {
+            it = trackCache_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TeamPredictor::predictTeams(const cv::Mat& frame,
+                                 const std::vector<Detection>& playerDetections,
+                                 std::vector<int>& teamIds) {
+    teamIds.clear();
     
     if (teamColors_.empty()) {
         std::cerr << "Warning: Team colors not configured" << std::endl;
-        return teamIds;
+        return;
     }
     
-    // 转换图像到RGB
-    cv::Mat frameRgb;
-    cv::cvtColor(frame, frameRgb, cv::COLOR_BGR2RGB);
+    frameCounter_++;
     
-    for (const auto& det : playerDetections) {
-        // 只处理球员（classId == 0）
-        if (det.classId == 0) {
-            // 提取颜色调色板（RGB空间）
-            std::vector<cv::Scalar> paletteRgb = extractColorPalette(frameRgb, det.bbox);
+    const int slots = std::min(std::max(numPaletteColors_, 1), kMaxPaletteColors);
+    
+    // 按输入顺序记录球员（classId == 0）的下标，保证输出顺序确定；
+    // 球场外的球员不做颜色分析，缓存命中的轨迹直接输出，其余的加入待计算列表
+    const bool useMask = pitchMask_ != nullptr && pitchMask_->isValid() &&
+                         pitchMask_->getFrameSize() == frame.size();
+    playerIndices_.clear();
+    computeSlots_.clear();
+    for (size_t i = 0; i < playerDetections.size(); i++) {
+        if (playerDetections[i].classId != 0) {
+            continue;
+        }
+        
+        int cachedTeam = 0;
+        if (useMask && !pitchMask_->containsFoot(playerDetections[i].bbox)) {
+            teamIds.push_back(-1);
+            cacheStats_.offPitch++;
+        } else if (lookupTrackCache(playerDetections[i].trackId, cachedTeam)) {
+            teamIds.push_back(cachedTeam);
+        } else {
+            teamIds.push_back(0);
+            computeSlots_.push_back(static_cast<int>(playerIndices_.size()));
+        }
+        playerIndices_.push_back(static_cast<int>(i));
+    }
+    size_t numCompute = computeSlots_.size();
+    
+    // 待计算球员的调色板按 [球员][颜色] 平铺存放（LAB分量SoA）
+    size_t numEntries = numCompute * slots;
+    paletteL_.assign(numEntries, 0.0f);
+    paletteA_.assign(numEntries, 0.0f);
+    paletteB_.assign(numEntries, 0.0f);
+    nearestRef_.resize(numEntries);
+    paletteCounts_.assign(numCompute, 0);
+    
+    // 1. 提取调色板：直接在原始BGR图像的ROI视图上采样，不做整帧颜色转换。
+    //    每个球员只写自己的槽位，可安全并行
+    auto extractRange = [&](const cv::Range& range) {
+        cv::Scalar colors[kMaxPaletteColors];
+        
+        for (int q = range.start; q < range.end; q++) {
+            const Detection& det = playerDetections[playerIndices_[computeSlots_[q]]];
             
-            // 转换到LAB空间
-            std::vector<cv::Scalar> paletteLab;
-            for (const auto& color : paletteRgb) {
-                paletteLab.push_back(rgbToLab(color));
+            int numColors = 0;
+            cv::Mat region = jerseyRegion(frame, det.bbox);
+            if (!region.empty()) {
+                numColors = (paletteMode_ == PaletteMode::KMeans)
+                    ? extractPaletteKMeans(region, colors)
+                    : extractPaletteHistogram(region, colors);
             }
             
-            // 预测球队
-            int teamId = predictTeamFromPalette(paletteLab);
-            teamIds.push_back(teamId);
+            // 查表转换到LAB空间
+            numColors = std::min(numColors, slots);
+            for (int c = 0; c < numColors; c++) {
+                const cv::Vec3b& lab = lookupLab(colors[c]);
+                size_t idx = static_cast<size_t>(q) * slots + c;
+                paletteL_[idx] = lab[0];
+                paletteA_[idx] = lab[1];
+                paletteB_[idx] = lab[2];
+            }
+            paletteCounts_[q] = numColors;
         }
+    };
+    
+    // 使用共享任务调度器或OpenCV的共享线程池，不单独创建线程
+    if (parallel_ && numCompute > 1 && taskScheduler_ != nullptr) {
+        taskScheduler_->parallelFor(cv::Range(0, static_cast<int>(numCompute)), extractRange);
+    } else if (parallel_ && numCompute > 1) {
+        cv::parallel_for_(cv::Range(0, static_cast<int>(numCompute)), extractRange);
+    } else {
+        extractRange(cv::Range(0, static_cast<int>(numCompute)));
     }
     
-    return teamIds;
+    // 2. 所有待计算球员的所有调色板颜色一次批量求最近参考色
+    nearestReferenceKernel(paletteL_.data(), paletteA_.data(), paletteB_.data(), numEntries,
+                           refL_.data(), refA_.data(), refB_.data(),
+                           static_cast<int>(refL_.size()), nearestRef_.data());
+    
+    // 3. 投票：每支球队有2种参考色（球员+守门员），平票取较小的球队ID
+    int numTeams = std::min(static_cast<int>((refL_.size() + 1) / 2), kMaxTeams);
+    
+    for (size_t q = 0; q < numCompute; q++) {
+        int votes[kMaxTeams] = {0};
+        for (int c = 0; c < paletteCounts_[q]; c++) {
+            int team = static_cast<int>(nearestRef_[q * slots + c]) / 2;
+            if (team < numTeams) {
+                votes[team]++;
+            }
+        }
+        
+        int predictedTeam = 0;  // 无调色板时默认第一支球队
+        for (int team = 1; team < numTeams; team++) {
+            if (votes[team] > votes[predictedTeam]) {
+                predictedTeam = team;
+            }
+        }
+        
+        int p = computeSlots_[q];
+        const Detection& det = playerDetections[playerIndices_[p]];
+        // 调色板为空（框过小或被遮挡）时不计入投票，到期刷新的轨迹沿用缓存的球队
+        teamIds[p] = paletteCounts_[q] > 0 ? updateTrackCache(det.trackId, predictedTeam)
+                                           : cachedTeamOrDefault(det.trackId, predictedTeam);
+    }
+    
+    if (trackCacheEnabled_ && frameCounter_ % 30 == 0) {
+        pruneTrackCache();
+    }
+}
+
+PaletteBenchmark TeamPredictor::benchmarkPaletteModes(const cv::Mat& frame,
+                                                     const std::vector<Detection>& playerDetections) {
+    PaletteBenchmark result;
+    
+    if (referenceColors_.empty()) {
+        return result;
+    }
+    
+    std::vector<cv::Scalar> histPalette;
+    std::vector<cv::Scalar> kmeansPalette;
+    std::vector<cv::Scalar> paletteLab;
+    
+    // 不经查找表量化的参考色，用于评估查找表对球队判定的影响
+    std::vector<cv::Scalar> exactReferences;
+    for (const auto& team : teamColors_) {
+        exactReferences.push_back(rgbToLabExact(team.playerColor));
+        exactReferences.push_back(rgbToLabExact(team.goalkeeperColor));
+    }
+    
+    for (const auto& det : playerDetections) {
+        if (det.classId != 0) {
+            continue;
+        }
+        
+        cv::Mat region = jerseyRegion(frame, det.bbox);
+        if (region.empty()) {
+            continue;
+        }
+        
+        cv::Scalar colors[kMaxPaletteColors];
+        
+        auto t0 = std::chrono::high_resolution_clock::now();
+        int numHist = extractPaletteHistogram(region, colors);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        histPalette.assign(colors, colors + numHist);
+        
+        auto t2 = std::chrono::high_resolution_clock::now();
+        int numKMeans = extractPaletteKMeans(region, colors);
+        auto t3 = std::chrono::high_resolution_clock::now();
+        kmeansPalette.assign(colors, colors + numKMeans);
+        
+        result.histogramMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        result.kmeansMs += std::chrono::duration<double, std::milli>(t3 - t2).count();
+        result.numCrops++;
+        
+        // 比较两种方式的球队预测结果
+        paletteLab.clear();
+        for (const auto& color : histPalette) {
+            paletteLab.push_back(rgbToLab(color));
+        }
+        int histTeam = predictTeamFromPalette(paletteLab);
+        
+        paletteLab.clear();
+        for (const auto& color : kmeansPalette) {
+            paletteLab.push_back(rgbToLab(color));
+        }
+        int kmeansTeam = predictTeamFromPalette(paletteLab);
+        
+        if (histTeam == kmeansTeam) {
+            result.teamAgreements++;
+        }
+        
+        // 比较查表LAB与精确LAB的球队预测结果
+        paletteLab.clear();
+        for (const auto& color : histPalette) {
+            paletteLab.push_back(rgbToLabExact(color));
+        }
+        if (predictTeamFromPalette(paletteLab, exactReferences) == histTeam) {
+            result.lutAgreements++;
+        }
+        if (!histPalette.empty()) {
+            result.lutLabError += computeLabDistance(rgbToLab(histPalette[0]),
+                                                     rgbToLabExact(histPalette[0]));
+        }
+        
+        // 比较主颜色
+        if (!histPalette.empty() && !kmeansPalette.empty()) {
+            result.dominantLabDistance += computeLabDistance(rgbToLab(histPalette[0]),
+                                                             rgbToLab(kmeansPalette[0]));
+        }
+    }
+    
+    return result;
 }
 
 } // namespace FootballAnalytics
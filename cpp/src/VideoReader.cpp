@@ -153,9 +153,9 @@ bool VideoReader::readFrame(cv::Mat& frame) {
                 sws_scale(swsCtx_, frame_->data, frame_->linesize,
                          0, height_, frameRGB_->data, frameRGB_->linesize);
                 
-                // 创建OpenCV Mat
-                frame = cv::Mat(height_, width_, CV_8UC3, frameRGB_->data[0],
-                               frameRGB_->linesize[0]).clone();
+                // 拷贝到输出Mat（尺寸一致时复用其缓冲区，不重新分配）
+                cv::Mat(height_, width_, CV_8UC3, frameRGB_->data[0],
+                        frameRGB_->linesize[0]).copyTo(frame);
                 
                 currentFrameNumber_++;
                 av_packet_unref(packet_);
@@ -1,16 +1,29 @@
 #include "YOLODetector.h"
+#include "PitchMask.h"
+#include "TaskScheduler.h"
+#include "FrameArena.h"
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
+#include <chrono>
 
 namespace FootballAnalytics {
 
+int YOLODetector::intraOpThreads_ = 4;
+
 YOLODetector::YOLODetector(const std::string& modelPath,
                            float confThreshold,
                            float iouThreshold)
     : inputSize_(640, 640)
+    , dynamicBatch_(false)
+    , dynamicShape_(false)
+    , tileSize_(0)
+    , tileOverlap_(0.2f)
     , confThreshold_(confThreshold)
     , iouThreshold_(iouThreshold)
+    , pitchMask_(nullptr)
+    , maskRejected_(0)
+    , taskScheduler_(nullptr)
 {
     try {
         std::cout << "Initializing ONNX Runtime..." << std::endl;
@@ -24,7 +37,7 @@ YOLODetector::YOLODetector(const std::string& modelPath,
         // 创建会话选项
         std::cout << "  Creating session options..." << std::endl;
         sessionOptions_ = std::make_unique<Ort::SessionOptions>();
-        sessionOptions_->SetIntraOpNumThreads(4);
+        sessionOptions_->SetIntraOpNumThreads(intraOpThreads_);
         sessionOptions_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
         
         // === GPU 加速配置 ===
@@ -83,13 +96,20 @@ YOLODetector::YOLODetector(const std::string& modelPath,
         
         if (inputDims.size() >= 4) {
             // 通常是 [batch, channels, height, width]
-            inputSize_.height = static_cast<int>(inputDims[2]);
-            inputSize_.width = static_cast<int>(inputDims[3]);
+            // 导出时使用dynamic=True则batch维与空间维均为-1，空间维保持默认640，可由setInputSize调整
+            dynamicBatch_ = inputDims[0] <= 0;
+            dynamicShape_ = inputDims[2] <= 0 || inputDims[3] <= 0;
+            if (!dynamicShape_) {
+                inputSize_.height = static_cast<int>(inputDims[2]);
+                inputSize_.width = static_cast<int>(inputDims[3]);
+            }
         }
         
         std::cout << "YOLO Detector initialized successfully" << std::endl;
         std::cout << "  Model: " << modelPath << std::endl;
         std::cout << "  Input size: " << inputSize_.width << "x" << inputSize_.height << std::endl;
+        std::cout << "  Dynamic batch: " << (dynamicBatch_ ? "yes" : "no") << std::endl;
+        std::cout << "  Dynamic input size: " << (dynamicShape_ ? "yes" : "no") << std::endl;
         std::cout << "  Confidence threshold: " << confThreshold_ << std::endl;
         std::cout << "  IoU threshold: " << iouThreshold_ << std::endl;
         
@@ -137,53 +157,55 @@ void YOLODetector::setClassLabels(const std::vector<std::string>& labels) {
     classLabels_ = labels;
 }
 
-std::vector<float> YOLODetector::preprocess(const cv::Mat& frame) {
-    cv::Mat resized;
-    cv::resize(frame, resized, inputSize_);
+bool YOLODetector::setInputSize(const cv::Size& size) {
+    // YOLOv8最大下采样步长为32，输入边长取32的倍数
+    cv::Size aligned(std::max(32, (size.width + 16) / 32 * 32),
+                     std::max(32, (size.height + 16) / 32 * 32));
+    if (aligned == inputSize_) {
+        return true;
+    }
+    if (!dynamicShape_) {
+        std::cerr << "Model input size is fixed at " << inputSize_.width << "x" << inputSize_.height
+                  << ", cannot switch to " << aligned.width << "x" << aligned.height << std::endl;
+        return false;
+    }
+    
+    // 预处理与后处理的缩放系数都由inputSize_计算，切换后坐标映射保持正确
+    inputSize_ = aligned;
+    return true;
+}
+
+void YOLODetector::preprocess(const cv::Mat& frame, float* dst) {
+    cv::resize(frame, resized_, inputSize_);
     
     // 转换为RGB
-    cv::Mat rgb;
-    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+    cv::cvtColor(resized_, rgb_, cv::COLOR_BGR2RGB);
     
     // 归一化到[0, 1]
-    rgb.convertTo(rgb, CV_32F, 1.0 / 255.0);
-    
-    // 转换为CHW格式（NCHW: batch, channel, height, width）
-    std::vector<float> inputTensor;
-    inputTensor.resize(3 * inputSize_.height * inputSize_.width);
-    
-    std::vector<cv::Mat> channels(3);
-    cv::split(rgb, channels);
+    rgb_.convertTo(normalized_, CV_32F, 1.0 / 255.0);
     
+    // 转换为CHW格式：各通道直接拆分到输入缓冲区（Mat头指向外部数据，不分配）
     int channelSize = inputSize_.height * inputSize_.width;
+    channels_.resize(3);
     for (int c = 0; c < 3; c++) {
-        std::memcpy(inputTensor.data() + c * channelSize,
-                   channels[c].data,
-                   channelSize * sizeof(float));
+        channels_[c] = cv::Mat(inputSize_.height, inputSize_.width, CV_32F, dst + c * channelSize);
     }
-    
-    return inputTensor;
+    cv::split(normalized_, channels_);
 }
 
-std::vector<Detection> YOLODetector::detect(const cv::Mat& frame) {
-    if (frame.empty()) {
-        return {};
-    }
-    
-    cv::Size originalSize = frame.size();
-    
-    // 预处理
-    std::vector<float> inputTensor = preprocess(frame);
+void YOLODetector::runBatch(const cv::Size* imageSizes, int batch, const cv::Point* offsets,
+                            std::vector<Detection>* results) {
+    const size_t imageSize = 3 * static_cast<size_t>(inputSize_.height) * inputSize_.width;
     
     // 创建输入tensor
-    std::vector<int64_t> inputShape = {1, 3, inputSize_.height, inputSize_.width};
+    const int64_t inputShape[4] = {batch, 3, inputSize_.height, inputSize_.width};
     
     Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(
         OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
     
     Ort::Value inputTensorValue = Ort::Value::CreateTensor<float>(
-        memoryInfo, inputTensor.data(), inputTensor.size(),
-        inputShape.data(), inputShape.size());
+        memoryInfo, inputBuffer_.data(), imageSize * batch,
+        inputShape, 4);
     
     // 运行推理
     auto outputTensors = session_->Run(
@@ -191,59 +213,245 @@ std::vector<Detection> YOLODetector::detect(const cv::Mat& frame) {
         inputNames_.data(), &inputTensorValue, 1,
         outputNames_.data(), outputNames_.size());
     
-    // 获取输出
-    float* outputData = outputTensors[0].GetTensorMutableData<float>();
+    // 输出形状 [batch, 4+num_classes, num_anchors]，直接读取ORT输出，不拷贝
+    const float* outputData = outputTensors[0].GetTensorData<float>();
     auto outputShape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
     
-    // 计算输出大小
-    size_t outputSize = 1;
-    for (auto dim : outputShape) {
-        outputSize *= dim;
+    if (outputShape.size() < 3) {
+        std::cerr << "Unexpected detector output rank: " << outputShape.size() << std::endl;
+        return;
+    }
+    
+    int numChannels = static_cast<int>(outputShape[1]);
+    int numAnchors = static_cast<int>(outputShape[2]);
+    size_t perImage = static_cast<size_t>(numChannels) * numAnchors;
+    
+    // 各图像的解析与NMS互不依赖，分块/批量推理时交给任务调度器并行；
+    // NMS前的候选框分配在执行线程的帧内存池中
+    auto postprocessRange = [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; b++) {
+            FrameArenaScope scope;
+            std::pmr::vector<Detection> candidates(scope.resource());
+            postprocess(outputData + b * perImage, numChannels, numAnchors, imageSizes[b],
+                        offsets != nullptr ? offsets + b : nullptr, candidates);
+            results[b] = nms(candidates);
+        }
+    };
+    if (taskScheduler_ != nullptr && batch > 1) {
+        taskScheduler_->parallelFor(cv::Range(0, batch), postprocessRange);
+    } else {
+        postprocessRange(cv::Range(0, batch));
+    }
+}
+
+std::vector<Detection> YOLODetector::detect(const cv::Mat& frame) {
+    if (frame.empty()) {
+        return {};
+    }
+    
+    // 整帧检测：图像即原图，尺寸与掩码一致时做掩码过滤
+    const cv::Point origin(0, 0);
+    bool masked = pitchMask_ != nullptr && pitchMask_->getFrameSize() == frame.size();
+    std::vector<std::vector<Detection>>& results = detectImages(&frame, 1, masked ? &origin : nullptr);
+    return std::move(results[0]);
+}
+
+std::vector<std::vector<Detection>> YOLODetector::detectBatch(const std::vector<cv::Mat>& images) {
+    return detectImages(images.data(), static_cast<int>(images.size()), nullptr);
+}
+
+std::vector<std::vector<Detection>>& YOLODetector::detectImages(const cv::Mat* images, int count,
+                                                                const cv::Point* offsets) {
+    imageResults_.resize(count);
+    for (auto& detections : imageResults_) {
+        detections.clear();
+    }
+    if (count == 0) {
+        return imageResults_;
     }
     
-    std::vector<float> output(outputData, outputData + outputSize);
+    const size_t imageSize = 3 * static_cast<size_t>(inputSize_.height) * inputSize_.width;
     
-    // 后处理
-    std::vector<Detection> detections = postprocess(output, originalSize);
+    // 固定batch=1的模型逐张推理
+    const int step = dynamicBatch_ ? count : 1;
     
-    // NMS
-    detections = nms(detections);
+    for (int start = 0; start < count; start += step) {
+        int batch = std::min(step, count - start);
+        
+        if (inputBuffer_.size() < imageSize * batch) {
+            inputBuffer_.resize(imageSize * batch);
+        }
+        
+        imageSizes_.clear();
+        for (int i = 0; i < batch; i++) {
+            preprocess(images[start + i], inputBuffer_.data() + i * imageSize);
+            imageSizes_.push_back(images[start + i].size());
+        }
+        
+        runBatch(imageSizes_.data(), batch, offsets != nullptr ? offsets + start : nullptr,
+                 imageResults_.data() + start);
+    }
     
-    return detections;
+    return imageResults_;
 }
 
-std::vector<Detection> YOLODetector::postprocess(const std::vector<float>& output,
-                                                 const cv::Size& frameSize) {
-    std::vector<Detection> detections;
+std::vector<Detection> YOLODetector::detectRegions(const cv::Mat& frame,
+                                                   const std::vector<cv::Rect>& regions) {
+    FrameArenaScope scope;
+    crops_.clear();
+    cropOffsets_.clear();
+    cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+    
+    for (const auto& region : regions) {
+        cv::Rect roi = region & frameRect;
+        if (roi.width > 0 && roi.height > 0) {
+            crops_.push_back(frame(roi));  // ROI视图，预处理时再缩放
+            cropOffsets_.push_back(roi.tl());
+        }
+    }
     
-    // YOLOv8输出格式：[batch, 4+num_classes, num_anchors]
-    // 需要转置为 [num_anchors, 4+num_classes]
+    bool masked = pitchMask_ != nullptr && pitchMask_->getFrameSize() == frame.size();
+    std::vector<std::vector<Detection>>& results = detectImages(
+        crops_.data(), static_cast<int>(crops_.size()), masked ? cropOffsets_.data() : nullptr);
+    crops_.clear();   // 不持有帧的引用
+    
+    // 映射回原始图像坐标，区域重叠时再做一次NMS
+    std::pmr::vector<Detection> merged(scope.resource());
+    for (size_t i = 0; i < results.size(); i++) {
+        const cv::Point offset = cropOffsets_[i];
+        for (auto& det : results[i]) {
+            det.bbox.x += offset.x;
+            det.bbox.y += offset.y;
+            det.center.x += offset.x;
+            det.center.y += offset.y;
+            merged.push_back(std::move(det));
+        }
+    }
     
-    // 假设输出形状为 [1, 84, 8400] for 80 classes
-    // 或 [1, num_classes+4, num_anchors]
+    if (results.size() > 1) {
+        return nms(merged);
+    }
+    return std::vector<Detection>(merged.begin(), merged.end());
+}
+
+void YOLODetector::setTiling(int tileSize, float overlap) {
+    tileSize_ = std::max(tileSize, 0);
+    tileOverlap_ = std::min(std::max(overlap, 0.0f), 0.5f);
+}
+
+void YOLODetector::tileRegions(const cv::Size& frameSize, std::vector<cv::Rect>& tiles) const {
+    tiles.clear();
+    int tileW = std::min(tileSize_, frameSize.width);
+    int tileH = std::min(tileSize_, frameSize.height);
+    int stepX = std::max(1, static_cast<int>(tileW * (1.0f - tileOverlap_)));
+    int stepY = std::max(1, static_cast<int>(tileH * (1.0f - tileOverlap_)));
+    
+    for (int y = 0; ; y += stepY) {
+        int ty = std::min(y, frameSize.height - tileH);
+        for (int x = 0; ; x += stepX) {
+            int tx = std::min(x, frameSize.width - tileW);
+            tiles.emplace_back(tx, ty, tileW, tileH);
+            if (tx + tileW >= frameSize.width) {
+                break;
+            }
+        }
+        if (ty + tileH >= frameSize.height) {
+            break;
+        }
+    }
+}
+
+std::vector<Detection> YOLODetector::detectTiled(const cv::Mat& frame) {
+    if (frame.empty()) {
+        return {};
+    }
+    if (tileSize_ <= 0 || (frame.cols <= tileSize_ && frame.rows <= tileSize_)) {
+        return detect(frame);
+    }
     
-    int numClasses = 80; // 默认值，可根据实际调整
-    int numAnchors = 8400; // 640x640输入的默认值
+    FrameArenaScope scope;
+    tileRegions(frame.size(), tiles_);
     
-    // 动态推断类别数
-    if (output.size() > 0) {
-        numAnchors = static_cast<int>(output.size() / (4 + numClasses));
-        if (!classLabels_.empty()) {
-            numClasses = static_cast<int>(classLabels_.size());
+    // 各分块一次批量推理
+    crops_.clear();
+    cropOffsets_.clear();
+    for (const auto& tile : tiles_) {
+        crops_.push_back(frame(tile));
+        cropOffsets_.push_back(tile.tl());
+    }
+    bool masked = pitchMask_ != nullptr && pitchMask_->getFrameSize() == frame.size();
+    std::vector<std::vector<Detection>>& results = detectImages(
+        crops_.data(), static_cast<int>(crops_.size()), masked ? cropOffsets_.data() : nullptr);
+    crops_.clear();   // 不持有帧的引用
+    
+    // 映射回原图坐标
+    std::pmr::vector<Detection> merged(scope.resource());
+    for (size_t i = 0; i < results.size(); i++) {
+        const cv::Point offset = cropOffsets_[i];
+        for (auto& det : results[i]) {
+            det.bbox.x += offset.x;
+            det.bbox.y += offset.y;
+            det.center.x += offset.x;
+            det.center.y += offset.y;
+            merged.push_back(std::move(det));
         }
     }
     
+    return mergeTiles(merged);
+}
+
+std::vector<Detection> YOLODetector::compareTiling(const cv::Mat& frame, TilingComparison& stats) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    std::vector<Detection> single = detect(frame);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<Detection> tiled = detectTiled(frame);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    
+    stats.frames++;
+    stats.singleMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+    stats.tiledMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    stats.singleDetections += single.size();
+    stats.tiledDetections += tiled.size();
+    
+    // 同类别IoU >= 0.5视为同一目标
+    std::vector<char> tiledMatched(tiled.size(), 0);
+    for (const auto& a : single) {
+        for (size_t j = 0; j < tiled.size(); j++) {
+            if (!tiledMatched[j] && tiled[j].classId == a.classId &&
+                computeIoU(a.bbox, tiled[j].bbox) >= 0.5f) {
+                tiledMatched[j] = 1;
+                stats.singleMatched++;
+                break;
+            }
+        }
+    }
+    for (char matched : tiledMatched) {
+        if (!matched) {
+            stats.tiledOnly++;
+        }
+    }
+    
+    return tiled;
+}
+
+void YOLODetector::postprocess(const float* output, int numChannels, int numAnchors,
+                               const cv::Size& frameSize, const cv::Point* maskOffset,
+                               std::pmr::vector<Detection>& detections) {
+    // YOLOv8输出格式：[4+num_classes, num_anchors]（通道优先）
+    // 类别数由输出形状确定，不依赖类别标签数量
+    int numClasses = numChannels - 4;
+    if (numClasses <= 0) {
+        return;
+    }
+    
     float scaleX = static_cast<float>(frameSize.width) / inputSize_.width;
     float scaleY = static_cast<float>(frameSize.height) / inputSize_.height;
     
+    // 掩码未就绪（尚未计算或非全景画面）时不过滤
+    const bool useMask = maskOffset != nullptr && pitchMask_ != nullptr && pitchMask_->isValid();
+    
     // 解析检测结果
     for (int i = 0; i < numAnchors; i++) {
-        // 获取边界框信息
-        float cx = output[i];
-        float cy = output[numAnchors + i];
-        float w = output[2 * numAnchors + i];
-        float h = output[3 * numAnchors + i];
-        
         // 查找最高置信度的类别
         float maxConf = 0.0f;
         int maxClassId = -1;
@@ -258,6 +466,19 @@ std::vector<Detection> YOLODetector::postprocess(const std::vector<float>& outpu
         
         // 过滤低置信度检测
         if (maxConf > confThreshold_) {
+            // 获取边界框信息
+            float cx = output[i];
+            float cy = output[numAnchors + i];
+            float w = output[2 * numAnchors + i];
+            float h = output[3 * numAnchors + i];
+            
+            // 脚底点在球场外（看台、替补席、广告牌）的候选框直接丢弃，不构造检测结果也不进入NMS
+            if (useMask && !pitchMask_->contains(cv::Point2f(cx * scaleX + maskOffset->x,
+                                                             (cy + h / 2.0f) * scaleY + maskOffset->y))) {
+                maskRejected_++;
+                continue;
+            }
+            
             Detection det;
             
             // 转换到原始图像坐标
@@ -280,8 +501,6 @@ std::vector<Detection> YOLODetector::postprocess(const std::vector<float>& outpu
             detections.push_back(det);
         }
     }
-    
-    return detections;
 }
 
 float YOLODetector::computeIoU(const cv::Rect& box1, const cv::Rect& box2) {
@@ -301,17 +520,16 @@ float YOLODetector::computeIoU(const cv::Rect& box1, const cv::Rect& box2) {
     return static_cast<float>(intersectionArea) / unionArea;
 }
 
-std::vector<Detection> YOLODetector::nms(const std::vector<Detection>& detections) {
+std::vector<Detection> YOLODetector::nms(std::pmr::vector<Detection>& sorted) {
     std::vector<Detection> result;
     
-    // 按置信度排序
-    std::vector<Detection> sorted = detections;
+    // 按置信度原地排序（候选框为临时数据，不再拷贝）
     std::sort(sorted.begin(), sorted.end(),
              [](const Detection& a, const Detection& b) {
                  return a.confidence > b.confidence;
              });
     
-    std::vector<bool> suppressed(sorted.size(), false);
+    std::pmr::vector<char> suppressed(sorted.size(), 0, sorted.get_allocator());
     
     for (size_t i = 0; i < sorted.size(); i++) {
         if (suppressed[i]) continue;
@@ -335,4 +553,38 @@ std::vector<Detection> YOLODetector::nms(const std::vector<Detection>& detection
     return result;
 }
 
+std::vector<Detection> YOLODetector::mergeTiles(std::pmr::vector<Detection>& sorted) {
+    constexpr float kContainedRatio = 0.7f;  // 交集占较小框面积的比例
+    
+    std::sort(sorted.begin(), sorted.end(),
+             [](const Detection& a, const Detection& b) {
+                 return a.confidence > b.confidence;
+             });
+    
+    std::vector<Detection> result;
+    std::pmr::vector<char> suppressed(sorted.size(), 0, sorted.get_allocator());
+    
+    for (size_t i = 0; i < sorted.size(); i++) {
+        if (suppressed[i]) continue;
+        
+        result.push_back(sorted[i]);
+        
+        for (size_t j = i + 1; j < sorted.size(); j++) {
+            if (suppressed[j] || sorted[i].classId != sorted[j].classId) continue;
+            
+            const cv::Rect& a = sorted[i].bbox;
+            const cv::Rect& b = sorted[j].bbox;
+            int intersection = (a & b).area();
+            int smaller = std::min(a.area(), b.area());
+            
+            if (computeIoU(a, b) > iouThreshold_ ||
+                (smaller > 0 && static_cast<float>(intersection) / smaller > kContainedRatio)) {
+                suppressed[j] = true;
+            }
+        }
+    }
+    
+    return result;
+}
+
 } // namespace FootballAnalytics
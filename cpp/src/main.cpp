@@ -1,16 +1,38 @@
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <iomanip>
+#include <memory>
+#include <sstream>
 
 #include "VideoReader.h"
 #include "YOLODetector.h"
 #include "TeamPredictor.h"
+#include "TeamColorCalibrator.h"
+#include "PlayerTracker.h"
+#include "BallTracker.h"
 #include "CoordinateTransform.h"
+#include "PitchMask.h"
+#include "SceneClassifier.h"
+#include "MotionGate.h"
+#include "ResolutionController.h"
+#include "RealtimeScheduler.h"
+#include "PipelineExecutor.h"
+#include "TaskScheduler.h"
+#include "FrameArena.h"
+#include "AllocationCounter.h"
 #include "ApiClient.h"
+#include "AsyncSender.h"
 
 using namespace FootballAnalytics;
 
+// 跟踪器低分检测阈值（检测器在启用跟踪时使用该阈值）
+constexpr float kTrackerLowThreshold = 0.1f;
+
+// 堆分配计数从该帧之后开始统计（跳过缓冲区与内存池的预热）
+constexpr int kAllocationWarmupFrames = 30;
+
 /**
  * @brief 显示使用说明
  */
@@ -28,6 +50,51 @@ void printUsage(const char* programName) {
     std::cout << "  --keypoint-conf <value>     Keypoint detection confidence threshold (default: 0.7)" << std::endl;
     std::cout << "  --team1-name <name>         First team name (default: Team1)" << std::endl;
     std::cout << "  --team2-name <name>         Second team name (default: Team2)" << std::endl;
+    std::cout << "  --track-homography          Propagate homography between keypoint detections via camera motion tracking" << std::endl;
+    std::cout << "  --keypoint-interval <n>     Keypoint model refresh interval with --track-homography (default: 25)" << std::endl;
+    std::cout << "  --palette-mode <mode>       Jersey palette extractor: hist or kmeans (default: hist)" << std::endl;
+    std::cout << "  --benchmark-palette         Compare hist and kmeans palette extractors on every frame" << std::endl;
+    std::cout << "  --team-refresh <n>          Recompute cached team labels of tracked players every n frames (default: 50)" << std::endl;
+    std::cout << "  --track                     Track players across frames (persistent track IDs, low-score detections fed to the tracker)" << std::endl;
+    std::cout << "  --detect-interval <n>       Run the player model at most every n frames, tracker predictions in between; > 1 implies --track (default: 1)" << std::endl;
+    std::cout << "  --fixed-interval            Use exactly --detect-interval instead of adapting it to scene motion" << std::endl;
+    std::cout << "  --flow-refine               Refine predicted player boxes with optical flow" << std::endl;
+    std::cout << "  --eval-detect-interval      Also run full detection on predicted frames and report position error" << std::endl;
+    std::cout << "  --ball-reset <n>            Reset the ball track after n frames without a ball (default: 30)" << std::endl;
+    std::cout << "  --ball-gate <px>            Maximum ball jump between frames in pixels (default: 100)" << std::endl;
+    std::cout << "  --ball-history <n>          Ball trajectory length in frames (default: 35)" << std::endl;
+    std::cout << "  --tile-size <px>            Run the player model on overlapping tiles of this size (default: 0 = off)" << std::endl;
+    std::cout << "  --tile-overlap <ratio>      Overlap between neighbouring tiles (default: 0.2)" << std::endl;
+    std::cout << "  --compare-tiling            Also run single-pass inference and report recall and throughput" << std::endl;
+    std::cout << "  --ball-roi                  Re-detect a missed ball on full-resolution crops around its predicted position" << std::endl;
+    std::cout << "  --ball-roi-crops <n>        Maximum crops per frame for --ball-roi (default: 4)" << std::endl;
+    std::cout << "  --auto-team-colors          Learn team colors from the first frames instead of the built-in colors" << std::endl;
+    std::cout << "  --calibration-frames <n>    Frames used for --auto-team-colors calibration (default: 50)" << std::endl;
+    std::cout << "  --pitch-mask <mode>         Drop detections off the pitch: off, grass, outline or auto (default: off)" << std::endl;
+    std::cout << "  --pitch-mask-interval <n>   Recompute the pitch mask every n frames (default: 10)" << std::endl;
+    std::cout << "  --scene-filter              Skip inference on close-ups, crowd shots, replays and graphics; reset tracking at cuts" << std::endl;
+    std::cout << "  --motion-gate <diff>        Reuse the last analysed frame when the mean luma difference is below diff (default: 0 = off)" << std::endl;
+    std::cout << "  --motion-gate-max-reuse <n> Analyse at least every n frames with --motion-gate (default: 10)" << std::endl;
+    std::cout << "  --latency-budget <ms>       Pick the player model input size per frame to fit this budget (dynamic-shape model, default: 0 = off)" << std::endl;
+    std::cout << "  --input-sizes <list>        Candidate input sizes for --latency-budget (default: 480,640,960)" << std::endl;
+    std::cout << "  --realtime                  Replay the video at its native frame rate like a live feed; degrade or drop late frames" << std::endl;
+    std::cout << "  --deadline-frames <n>       Per-frame deadline in source frame periods with --realtime (default: 1.5)" << std::endl;
+    std::cout << "  --pipeline                  Run decode, detection, analysis, serialization and upload as concurrent stages" << std::endl;
+    std::cout << "  --pipeline-depth <n>        Maximum frames in flight with --pipeline (default: 16)" << std::endl;
+    std::cout << "  --detect-workers <n>        Detection stage threads with --pipeline, one model instance each (default: 2)" << std::endl;
+    std::cout << "  --serialize-workers <n>     JSON serialization threads with --pipeline (default: 1)" << std::endl;
+    std::cout << "  --task-threads <n>          Shared work-stealing pool for team colors, NMS, geometry and serialization (default: 0 = off)" << std::endl;
+    std::cout << "  --pin-threads               Pin --task-threads workers to the first n cores, inference to the rest" << std::endl;
+    std::cout << "  --benchmark-scaling         Time team prediction, geometry, detection post-processing and serialization on 1..N pinned cores, then exit" << std::endl;
+    std::cout << "  --async-send                Upload frames from background threads through a bounded queue" << std::endl;
+    std::cout << "  --send-queue <n>            Frames buffered in memory with --async-send (default: 64)" << std::endl;
+    std::cout << "  --send-workers <n>          Upload threads with --async-send, one connection each (default: 1)" << std::endl;
+    std::cout << "  --send-overflow <policy>    When the send queue is full: block, drop-oldest or spill (default: block)" << std::endl;
+    std::cout << "  --spill-file <path>         Overflow file for --send-overflow spill (default: ./send_spill.jsonl)" << std::endl;
+    std::cout << "  --send-retries <n>          Retries with exponential backoff after transport errors or 5xx; 4xx is not retried (default: 3)" << std::endl;
+    std::cout << "  --batch-frames <n>          Upload up to n frames per request to /api/frames/batch (implies --async-send)" << std::endl;
+    std::cout << "  --batch-ms <ms>             Send a partial batch once its oldest frame has waited this long (default: 100)" << std::endl;
+    std::cout << "  --compress <codec>          Request body compression: none, gzip or zstd (default: none)" << std::endl;
     std::cout << "  --debug                     Enable debug mode" << std::endl;
     std::cout << "  --help                      Show this help message" << std::endl;
     std::cout << std::endl;
@@ -48,6 +115,51 @@ struct Config {
     float keypointConfThreshold = 0.7f;
     std::string team1Name = "Team1";
     std::string team2Name = "Team2";
+    bool trackHomography = false;
+    int keypointInterval = 25;
+    std::string paletteMode = "hist";
+    bool benchmarkPalette = false;
+    int teamRefreshInterval = 50;
+    bool trackPlayers = false;
+    int detectInterval = 1;
+    bool fixedInterval = false;
+    bool flowRefine = false;
+    bool evalDetectInterval = false;
+    int ballResetFrames = 30;
+    float ballGateDistance = 100.0f;
+    int ballHistoryLength = 35;
+    int tileSize = 0;
+    float tileOverlap = 0.2f;
+    bool compareTiling = false;
+    bool ballRoi = false;
+    int ballRoiCrops = 4;
+    bool autoTeamColors = false;
+    int calibrationFrames = 50;
+    std::string pitchMask = "off";
+    int pitchMaskInterval = 10;
+    bool sceneFilter = false;
+    float motionGateThreshold = 0.0f;
+    int motionGateMaxReuse = 10;
+    double latencyBudgetMs = 0.0;
+    std::vector<int> inputSizes = {480, 640, 960};
+    bool realtime = false;
+    double deadlineFrames = 1.5;
+    bool pipeline = false;
+    int pipelineDepth = 16;
+    int detectWorkers = 2;
+    int serializeWorkers = 1;
+    int taskThreads = 0;
+    bool pinThreads = false;
+    bool benchmarkScaling = false;
+    bool asyncSend = false;
+    int sendQueue = 64;
+    int sendWorkers = 1;
+    std::string sendOverflow = "block";
+    std::string spillFile = "./send_spill.jsonl";
+    int sendRetries = 3;
+    int batchFrames = 1;
+    int batchMs = 100;
+    std::string compress = "none";
     bool debugMode = false;
 };
 
@@ -75,6 +187,101 @@ bool parseArguments(int argc, char** argv, Config& config) {
             config.team1Name = argv[++i];
         } else if (arg == "--team2-name" && i + 1 < argc) {
             config.team2Name = argv[++i];
+        } else if (arg == "--track-homography") {
+            config.trackHomography = true;
+        } else if (arg == "--keypoint-interval" && i + 1 < argc) {
+            config.keypointInterval = std::stoi(argv[++i]);
+        } else if (arg == "--palette-mode" && i + 1 < argc) {
+            config.paletteMode = argv[++i];
+        } else if (arg == "--benchmark-palette") {
+            config.benchmarkPalette = true;
+        } else if (arg == "--team-refresh" && i + 1 < argc) {
+            config.teamRefreshInterval = std::stoi(argv[++i]);
+        } else if (arg == "--track") {
+            config.trackPlayers = true;
+        } else if (arg == "--detect-interval" && i + 1 < argc) {
+            config.detectInterval = std::stoi(argv[++i]);
+        } else if (arg == "--fixed-interval") {
+            config.fixedInterval = true;
+        } else if (arg == "--flow-refine") {
+            config.flowRefine = true;
+        } else if (arg == "--eval-detect-interval") {
+            config.evalDetectInterval = true;
+        } else if (arg == "--ball-reset" && i + 1 < argc) {
+            config.ballResetFrames = std::stoi(argv[++i]);
+        } else if (arg == "--ball-gate" && i + 1 < argc) {
+            config.ballGateDistance = std::stof(argv[++i]);
+        } else if (arg == "--ball-history" && i + 1 < argc) {
+            config.ballHistoryLength = std::stoi(argv[++i]);
+        } else if (arg == "--tile-size" && i + 1 < argc) {
+            config.tileSize = std::stoi(argv[++i]);
+        } else if (arg == "--tile-overlap" && i + 1 < argc) {
+            config.tileOverlap = std::stof(argv[++i]);
+        } else if (arg == "--compare-tiling") {
+            config.compareTiling = true;
+        } else if (arg == "--ball-roi") {
+            config.ballRoi = true;
+        } else if (arg == "--ball-roi-crops" && i + 1 < argc) {
+            config.ballRoiCrops = std::stoi(argv[++i]);
+        } else if (arg == "--auto-team-colors") {
+            config.autoTeamColors = true;
+        } else if (arg == "--calibration-frames" && i + 1 < argc) {
+            config.calibrationFrames = std::stoi(argv[++i]);
+        } else if (arg == "--pitch-mask" && i + 1 < argc) {
+            config.pitchMask = argv[++i];
+        } else if (arg == "--pitch-mask-interval" && i + 1 < argc) {
+            config.pitchMaskInterval = std::stoi(argv[++i]);
+        } else if (arg == "--scene-filter") {
+            config.sceneFilter = true;
+        } else if (arg == "--motion-gate" && i + 1 < argc) {
+            config.motionGateThreshold = std::stof(argv[++i]);
+        } else if (arg == "--motion-gate-max-reuse" && i + 1 < argc) {
+            config.motionGateMaxReuse = std::stoi(argv[++i]);
+        } else if (arg == "--latency-budget" && i + 1 < argc) {
+            config.latencyBudgetMs = std::stod(argv[++i]);
+        } else if (arg == "--input-sizes" && i + 1 < argc) {
+            config.inputSizes.clear();
+            std::stringstream sizes(argv[++i]);
+            std::string item;
+            while (std::getline(sizes, item, ',')) {
+                config.inputSizes.push_back(std::stoi(item));
+            }
+        } else if (arg == "--realtime") {
+            config.realtime = true;
+        } else if (arg == "--deadline-frames" && i + 1 < argc) {
+            config.deadlineFrames = std::stod(argv[++i]);
+        } else if (arg == "--pipeline") {
+            config.pipeline = true;
+        } else if (arg == "--pipeline-depth" && i + 1 < argc) {
+            config.pipelineDepth = std::stoi(argv[++i]);
+        } else if (arg == "--detect-workers" && i + 1 < argc) {
+            config.detectWorkers = std::stoi(argv[++i]);
+        } else if (arg == "--serialize-workers" && i + 1 < argc) {
+            config.serializeWorkers = std::stoi(argv[++i]);
+        } else if (arg == "--task-threads" && i + 1 < argc) {
+            config.taskThreads = std::stoi(argv[++i]);
+        } else if (arg == "--pin-threads") {
+            config.pinThreads = true;
+        } else if (arg == "--benchmark-scaling") {
+            config.benchmarkScaling = true;
+        } else if (arg == "--async-send") {
+            config.asyncSend = true;
+        } else if (arg == "--send-queue" && i + 1 < argc) {
+            config.sendQueue = std::stoi(argv[++i]);
+        } else if (arg == "--send-workers" && i + 1 < argc) {
+            config.sendWorkers = std::stoi(argv[++i]);
+        } else if (arg == "--send-overflow" && i + 1 < argc) {
+            config.sendOverflow = argv[++i];
+        } else if (arg == "--spill-file" && i + 1 < argc) {
+            config.spillFile = argv[++i];
+        } else if (arg == "--send-retries" && i + 1 < argc) {
+            config.sendRetries = std::stoi(argv[++i]);
+        } else if (arg == "--batch-frames" && i + 1 < argc) {
+            config.batchFrames = std::stoi(argv[++i]);
+        } else if (arg == "--batch-ms" && i + 1 < argc) {
+            config.batchMs = std::stoi(argv[++i]);
+        } else if (arg == "--compress" && i + 1 < argc) {
+            config.compress = argv[++i];
         } else if (arg == "--debug") {
             config.debugMode = true;
         }
@@ -83,6 +290,146 @@ bool parseArguments(int argc, char** argv, Config& config) {
     return !config.videoPath.empty();
 }
 
+/**
+ * @brief 多核扩展性测试：在采样帧上分别用1..N个核心运行调度器上的各阶段，输出每帧耗时、加速比与并行效率
+ *
+ * 每一档将调度器工作线程绑定到核心0..n-2、调用线程绑定到核心n-1。
+ * 检测一列为2x2区域批量检测（后处理/NMS在调度器上并行），包含ONNX Runtime推理，
+ * 推理线程在测试前创建、不受绑定限制；单应性与投影和球队预测并行，与分析阶段相同。
+ */
+void runScalingBenchmark(VideoReader& videoReader, YOLODetector& playerDetector, YOLODetector& keypointDetector,
+                         TeamPredictor& teamPredictor, CoordinateTransform& coordTransform, ApiClient& apiClient) {
+    constexpr int kSampleFrames = 30;
+    constexpr int kSampleStride = 10;
+    
+    // 采样含球员的帧（检测只运行一次，不计入测试）
+    std::vector<cv::Mat> frames;
+    std::vector<FrameData> samples;
+    cv::Mat frame;
+    for (int index = 0; static_cast<int>(frames.size()) < kSampleFrames && videoReader.readFrame(frame); index++) {
+        if (index % kSampleStride != 0) {
+            continue;
+        }
+        FrameData data;
+        data.frameNumber = index + 1;
+        for (const auto& det : playerDetector.detect(frame)) {
+            if (det.classId == 0) {
+                data.players.push_back(det);
+            }
+        }
+        if (!data.players.empty()) {
+            data.keypoints = keypointDetector.detect(frame);
+            frames.push_back(frame.clone());
+            samples.push_back(data);
+        }
+    }
+    if (samples.empty()) {
+        std::cerr << "Scaling benchmark: no frames with players" << std::endl;
+        return;
+    }
+    
+    // 关闭轨迹缓存，每次都完整计算球队颜色
+    teamPredictor.setTrackCache(false);
+    const bool predictTeams = teamPredictor.getNumTeams() > 0;
+    if (!predictTeams) {
+        std::cerr << "Scaling benchmark: no team colors, team prediction skipped" << std::endl;
+    }
+    
+    // 2x2区域批量检测（模型不支持动态batch时逐区域推理，后处理不会并行）
+    std::vector<cv::Rect> regions;
+    const int halfW = frames[0].cols / 2;
+    const int halfH = frames[0].rows / 2;
+    for (int r = 0; r < 2; r++) {
+        for (int c = 0; c < 2; c++) {
+            regions.emplace_back(c * halfW, r * halfH, halfW, halfH);
+        }
+    }
+    
+    int maxCores = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    std::vector<int> allCores;
+    for (int core = 0; core < maxCores; core++) {
+        allCores.push_back(core);
+    }
+    bool pinned = TaskScheduler::pinCurrentThread(allCores);
+    if (!pinned) {
+        std::cerr << "Scaling benchmark: thread pinning not supported, cores are thread counts" << std::endl;
+    }
+    std::cout << "Scaling benchmark (" << samples.size() << " frames" << (pinned ? ", pinned" : "")
+             << "): cores, team+geometry ms/frame, detect ms/frame, serialize ms/frame, speedup, efficiency"
+             << std::endl;
+    
+    std::vector<ProjectionBuffer> projections(samples.size());
+    double baselineMs = 0.0;
+    for (int cores = 1; cores <= maxCores; cores++) {
+        // 调用线程也参与执行任务，工作线程数为核心数减一
+        std::vector<int> workerCores;
+        if (pinned) {
+            for (int core = 0; core < cores - 1; core++) {
+                workerCores.push_back(core);
+            }
+            TaskScheduler::pinCurrentThread({cores - 1});
+        }
+        TaskScheduler scheduler(cores - 1, workerCores);
+        teamPredictor.setTaskScheduler(&scheduler);
+        playerDetector.setTaskScheduler(&scheduler);
+        coordTransform.reset();
+        
+        auto teamStart = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < samples.size(); i++) {
+            TaskGroup geometry(&scheduler);
+            geometry.run([&]() {
+                if (samples[i].keypoints.size() >= 4) {
+                    coordTransform.computeHomography(samples[i].keypoints, samples[i].frameNumber);
+                }
+                if (coordTransform.hasValidHomography()) {
+                    coordTransform.projectDetections(samples[i].players, samples[i].balls, projections[i]);
+                }
+            });
+            if (predictTeams) {
+                teamPredictor.predictTeams(frames[i], samples[i].players, samples[i].teamIds);
+            }
+            geometry.wait();
+        }
+        double teamMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - teamStart).count();
+        
+        auto detectStart = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < samples.size(); i++) {
+            playerDetector.detectRegions(frames[i], regions);
+        }
+        double detectMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - detectStart).count();
+        
+        std::vector<std::string> json(samples.size());
+        auto serializeStart = std::chrono::high_resolution_clock::now();
+        scheduler.parallelFor(cv::Range(0, static_cast<int>(samples.size())), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                json[i] = apiClient.serializeFrameData(samples[i]);
+            }
+        });
+        double serializeMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - serializeStart).count();
+        
+        double totalMs = teamMs + detectMs + serializeMs;
+        if (cores == 1) {
+            baselineMs = totalMs;
+        }
+        double speedup = baselineMs / std::max(totalMs, 1e-6);
+        std::cout << "  " << cores << ": " << std::fixed << std::setprecision(3)
+                 << teamMs / samples.size() << ", " << detectMs / samples.size() << ", "
+                 << serializeMs / samples.size() << ", "
+                 << std::setprecision(2) << speedup << "x, " << std::setprecision(1)
+                 << 100.0 * speedup / cores << "%" << std::endl;
+        
+        teamPredictor.setTaskScheduler(nullptr);
+        playerDetector.setTaskScheduler(nullptr);
+    }
+    
+    if (pinned) {
+        TaskScheduler::pinCurrentThread(allCores);
+    }
+}
+
 /**
  * @brief 主函数
  */
@@ -110,37 +457,141 @@ int main(int argc, char** argv) {
             return 1;
         }
         
+        // 共享任务调度器：球队预测、检测后处理/NMS、单应性与序列化提交到同一组工作线程
+        std::unique_ptr<TaskScheduler> taskScheduler;
+        if (config.taskThreads > 0) {
+            std::vector<int> workerCores;
+            int numCores = static_cast<int>(std::thread::hardware_concurrency());
+            if (config.pinThreads && config.taskThreads < numCores) {
+                // 前n个核心给工作线程，其余留给推理：主线程先绑定到其余核心，
+                // 之后创建的ONNX Runtime与OpenCV线程继承该绑定，线程数与核心数一致
+                std::vector<int> inferenceCores;
+                for (int core = 0; core < numCores; core++) {
+                    (core < config.taskThreads ? workerCores : inferenceCores).push_back(core);
+                }
+                if (TaskScheduler::pinCurrentThread(inferenceCores)) {
+                    YOLODetector::setIntraOpThreads(static_cast<int>(inferenceCores.size()));
+                    cv::setNumThreads(static_cast<int>(inferenceCores.size()));
+                } else {
+                    std::cerr << "Warning: thread pinning not supported, --pin-threads ignored" << std::endl;
+                    workerCores.clear();
+                }
+            } else if (config.pinThreads) {
+                std::cerr << "Warning: --pin-threads needs fewer task threads than cores (" << numCores
+                         << "), ignored" << std::endl;
+            }
+            taskScheduler.reset(new TaskScheduler(config.taskThreads, workerCores));
+            std::cout << "Task scheduler: " << config.taskThreads << " threads"
+                     << (workerCores.empty() ? "" : " (pinned)") << std::endl;
+        }
+        
         // 2. 初始化YOLO检测器
         std::cout << "[2/7] Loading detection models..." << std::endl;
-        YOLODetector playerDetector(config.playerModelPath, config.playerConfThreshold);
+        // 隔帧检测需要跟踪器提供预测框
+        if (config.detectInterval > 1) {
+            config.trackPlayers = true;
+        }
+        // 启用跟踪时检测器输出低分检测，由跟踪器用于延续已有轨迹（ByteTrack）
+        PlayerTracker playerTracker(config.playerConfThreshold, kTrackerLowThreshold,
+                                    config.playerConfThreshold + 0.1f);
+        YOLODetector playerDetector(config.playerModelPath,
+                                    config.trackPlayers ? kTrackerLowThreshold : config.playerConfThreshold);
         YOLODetector keypointDetector(config.keypointModelPath, config.keypointConfThreshold);
         
+        playerTracker.setFlowRefinement(config.flowRefine && config.detectInterval > 1);
+        DetectionScheduler detectionScheduler(config.detectInterval, !config.fixedInterval);
+        BallTracker ballTracker(config.ballResetFrames, config.ballGateDistance, config.ballHistoryLength);
+        
         // 设置类别标签
         std::vector<std::string> playerLabels = {"player", "referee", "ball"};
         playerDetector.setClassLabels(playerLabels);
+        playerDetector.setTiling(config.tileSize, config.tileOverlap);
+        playerDetector.setTaskScheduler(taskScheduler.get());
+        keypointDetector.setTaskScheduler(taskScheduler.get());
+        
+        // 按延迟预算逐帧选择输入分辨率（需要动态尺寸导出的模型）
+        std::unique_ptr<ResolutionController> resolutionController;
+        if (config.latencyBudgetMs > 0.0) {
+            if (playerDetector.supportsDynamicShape()) {
+                resolutionController.reset(new ResolutionController(
+                    config.inputSizes, config.latencyBudgetMs, playerDetector.getInputSize().width));
+            } else {
+                std::cerr << "Warning: player model has a fixed input size, --latency-budget ignored" << std::endl;
+            }
+        }
         
         // 3. 初始化球队预测器
         std::cout << "[3/7] Initializing team predictor..." << std::endl;
         TeamPredictor teamPredictor(3); // 提取3种主要颜色
         
-        // 设置球队颜色（示例颜色，实际应从配置读取）
+        // 设置球队颜色（示例颜色；自动标定模式下由前N帧学习得到，失败时回退到示例颜色）
         TeamColorInfo team1(config.team1Name, 
                            cv::Scalar(30, 37, 48),    // 深蓝色
                            cv::Scalar(245, 253, 21)); // 黄色
         TeamColorInfo team2(config.team2Name,
                            cv::Scalar(251, 252, 250),  // 白色
                            cv::Scalar(177, 252, 196)); // 浅绿色
-        teamPredictor.setTeamColors(team1, team2);
+        std::unique_ptr<TeamColorCalibrator> teamCalibrator;
+        if (config.autoTeamColors) {
+            // 短片段最晚在视频中段完成标定
+            teamCalibrator.reset(new TeamColorCalibrator(config.calibrationFrames,
+                                                         videoReader.getTotalFrames() / 2));
+            std::cout << "Team colors will be calibrated from the first "
+                     << config.calibrationFrames << " frames with players" << std::endl;
+        } else {
+            teamPredictor.setTeamColors(team1, team2);
+        }
+        
+        // 标定结束后设置球队颜色，失败时回退到示例颜色
+        auto applyTeamCalibration = [&]() {
+            TeamColorInfo learned1, learned2;
+            if (teamCalibrator->getTeamColors(config.team1Name, config.team2Name, learned1, learned2)) {
+                teamPredictor.setTeamColors(learned1, learned2);
+            } else {
+                std::cerr << "Warning: falling back to the built-in team colors" << std::endl;
+                teamPredictor.setTeamColors(team1, team2);
+            }
+            teamCalibrator.reset();
+        };
+        teamPredictor.setPaletteMode(config.paletteMode == "kmeans" ? PaletteMode::KMeans
+                                                                    : PaletteMode::Histogram);
+        teamPredictor.setTrackCache(true, config.teamRefreshInterval);
+        teamPredictor.setTaskScheduler(taskScheduler.get());
         
         // 4. 初始化坐标转换器
         std::cout << "[4/7] Initializing coordinate transform..." << std::endl;
         CoordinateTransform coordTransform(config.keypointMapPath, 7.0f);
         coordTransform.loadTacticalMap(config.tacticalMapPath);
+        coordTransform.setMotionTracking(config.trackHomography, config.keypointInterval);
+        
+        // 球场掩码：过滤场外检测，只对场内球员做球队颜色分析
+        const bool usePitchMask = config.pitchMask != "off";
+        PitchMask pitchMask(160, config.pitchMaskInterval);
+        if (config.pitchMask == "grass") {
+            pitchMask.setSource(PitchMaskSource::Grass);
+        } else if (config.pitchMask == "outline") {
+            pitchMask.setSource(PitchMaskSource::Outline);
+        }
+        if (usePitchMask) {
+            playerDetector.setPitchMask(&pitchMask);
+            teamPredictor.setPitchMask(&pitchMask);
+        }
         
         // 5. 初始化API客户端
         std::cout << "[5/7] Connecting to API server..." << std::endl;
         ApiClient apiClient(config.apiUrl, config.apiKey);
         apiClient.setDebug(config.debugMode);
+        apiClient.setTaskScheduler(taskScheduler.get());
+        if (config.compress == "gzip") {
+            apiClient.setCompression(Compression::Gzip);
+        } else if (config.compress == "zstd") {
+            apiClient.setCompression(Compression::Zstd);
+        }
+        
+        if (config.benchmarkScaling) {
+            runScalingBenchmark(videoReader, playerDetector, keypointDetector, teamPredictor, coordTransform, apiClient);
+            return 0;
+        }
         
         // 测试API连接
         if (!apiClient.testConnection()) {
@@ -156,75 +607,302 @@ int main(int argc, char** argv) {
         // 通知视频处理开始
         apiClient.notifyVideoStart(config.videoPath, videoReader.getTotalFrames());
         
+        // 异步发送：帧循环只入队，服务器变慢或超时不阻塞推理
+        std::unique_ptr<AsyncSender> asyncSender;
+        if (config.asyncSend || config.batchFrames > 1) {
+            AsyncSendOptions sendOptions;
+            sendOptions.capacity = static_cast<size_t>(std::max(config.sendQueue, 1));
+            sendOptions.workers = config.sendWorkers;
+            sendOptions.spillPath = config.spillFile;
+            sendOptions.maxRetries = std::max(config.sendRetries, 0);
+            sendOptions.batchFrames = std::max(config.batchFrames, 1);
+            sendOptions.batchWindowMs = std::max(config.batchMs, 0);
+            if (config.sendOverflow == "drop-oldest") {
+                sendOptions.overflow = OverflowPolicy::DropOldest;
+            } else if (config.sendOverflow == "spill") {
+                sendOptions.overflow = OverflowPolicy::Spill;
+            }
+            asyncSender.reset(new AsyncSender(apiClient, sendOptions));
+        }
+        
         // 6. 处理视频帧
         std::cout << "[6/7] Processing video frames..." << std::endl;
         std::cout << "Total frames: " << videoReader.getTotalFrames() << std::endl;
         std::cout << std::endl;
         
-        cv::Mat frame;
-        int frameNumber = 0;
+        SceneClassifier sceneClassifier;
+        bool sceneWasTactical = true;
+        int sceneResets = 0;
+        MotionGate motionGate(config.motionGateThreshold, config.motionGateMaxReuse);
+        FrameData lastAnalysed;       // 最近一次完整分析的帧（运动门控复用）
+        std::vector<std::pair<int, int>> lastTrackTeams;  // 该帧的 (trackId, teamId)，按trackId排序
+        ProjectionBuffer projection;  // 跨帧复用的投影缓冲区
+        PaletteBenchmark paletteBenchmark;
+        PredictionEval predictionEval;
+        TilingComparison tilingComparison;
+        std::vector<Detection> playerDetections;
+        double detectMs = 0.0;
+        int detectCalls = 0;
+        std::vector<cv::Rect> ballRegions;
+        int ballRoiPasses = 0;
+        int ballRoiCropCount = 0;
+        int ballRoiHits = 0;
+        double ballRoiMs = 0.0;
         int processedFrames = 0;
+        long long warmAllocations = 0;   // 预热结束时的堆分配次数
+        std::vector<StageStats> pipelineStats;
         
-        auto startTime = std::chrono::high_resolution_clock::now();
+        // 实时模式：按源帧率回放（模拟直播源），落后时降级或丢帧以保持延迟有界
+        std::unique_ptr<RealtimeScheduler> realtimeScheduler;
+        if (config.realtime && config.pipeline) {
+            std::cerr << "Warning: frames queue up between pipeline stages, --realtime ignored with --pipeline" << std::endl;
+        } else if (config.realtime) {
+            realtimeScheduler.reset(new RealtimeScheduler(videoReader.getFPS(), config.deadlineFrames));
+        }
         
-        while (videoReader.readFrame(frame)) {
-            frameNumber++;
-            
-            auto frameStartTime = std::chrono::high_resolution_clock::now();
+        // 单帧分析：顺序模式在主循环中调用，流水线模式作为按帧序执行的分析阶段
+        // 降级帧跳过关键点、球队预测、球ROI二次检测等可延后的阶段；返回false表示画面分类跳过的非比赛画面
+        auto analyseFrame = [&](PipelineFrame& item, bool degraded) -> bool {
+            // 本帧各模块的临时数据分配在帧内存池中，帧结束时整体回收
+            FrameArenaScope arenaScope;
+            cv::Mat& frame = item.frame;
+            FrameData& frameData = item.data;
+            const int frameNumber = static_cast<int>(item.index) + 1;
             
             // 创建帧数据
-            FrameData frameData;
             frameData.frameNumber = frameNumber;
             frameData.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count();
             frameData.videoSource = config.videoPath;
             
-            // 检测球员和球
-            auto playerDetections = playerDetector.detect(frame);
-            
-            // 分离球员和球
-            for (const auto& det : playerDetections) {
-                if (det.classId == 0) { // 球员
-                    frameData.players.push_back(det);
-                } else if (det.classId == 2) { // 球
-                    frameData.balls.push_back(det);
+            // 画面分类：特写、观众、回放、图形包装等非比赛画面跳过推理
+            if (config.sceneFilter) {
+                const SceneInfo& scene = sceneClassifier.classify(frame);
+                frameData.sceneType = SceneClassifier::typeName(scene.type);
+                
+                // 镜头切换或重新回到比赛画面时，跟踪与单应性状态不再有效
+                if (scene.cut || (scene.isTactical() && !sceneWasTactical)) {
+                    playerTracker.reset();
+                    ballTracker.reset();
+                    coordTransform.reset();
+                    pitchMask.reset();
+                    motionGate.reset();
+                    detectionScheduler.requestDetection();
+                    sceneResets++;
+                }
+                sceneWasTactical = scene.isTactical();
+                
+                if (!scene.isTactical()) {
+                    return false;
                 }
             }
             
-            // 检测球场关键点
-            frameData.keypoints = keypointDetector.detect(frame);
+            double frameDetectMs = 0.0;
             
-            // 计算单应性矩阵
-            if (frameData.keypoints.size() >= 4) {
-                coordTransform.computeHomography(frameData.keypoints, frameNumber);
+            // 近重复帧：复用上一分析帧的结果，跳过模型推理
+            bool reuseFrame = motionGate.shouldReuse(frame);
+            if (reuseFrame) {
+                frameData.players = lastAnalysed.players;
+                frameData.teamIds = lastAnalysed.teamIds;
+                frameData.reused = true;
+                
+                // 有跟踪器时用运动模型传播球员位置，球队沿用该轨迹上一分析帧的标签
+                if (config.trackPlayers) {
+                    playerTracker.predictOnly(frameData.players, frame);
+                    if (!lastAnalysed.teamIds.empty()) {
+                        frameData.teamIds.clear();
+                        for (const auto& player : frameData.players) {
+                            auto it = std::lower_bound(lastTrackTeams.begin(), lastTrackTeams.end(), player.trackId,
+                                                       [](const std::pair<int, int>& entry, int trackId) {
+                                                           return entry.first < trackId;
+                                                       });
+                            bool found = it != lastTrackTeams.end() && it->first == player.trackId;
+                            frameData.teamIds.push_back(found ? it->second : -1);
+                        }
+                    }
+                }
+                
+                // 球不沿用上一分析帧的检测（否则被当作新观测，速度被拉向零）：
+                // 本帧没有球的检测，球轨迹只做预测
+                frameData.ballState = ballTracker.update(frameData.balls, frameNumber);
+            } else {
+                // 按需更新球场掩码（间隔刷新或单应性更新后）
+                if (usePitchMask && !degraded) {
+                    pitchMask.update(frame, frameNumber, coordTransform);
+                }
+                
+                // 检测球员和球（隔帧检测模式下其余帧由跟踪器预测）
+                bool runDetection = detectionScheduler.shouldDetect();
+                playerDetections.clear();
+                if (runDetection || config.evalDetectInterval) {
+                    if (item.detected) {
+                        // 流水线检测阶段已预取
+                        playerDetections.swap(item.detections);
+                        frameDetectMs = item.detectMs;
+                    } else {
+                        if (resolutionController) {
+                            int size = resolutionController->currentSize();
+                            playerDetector.setInputSize(cv::Size(size, size));
+                        }
+                        
+                        auto detectStart = std::chrono::high_resolution_clock::now();
+                        if (config.compareTiling && config.tileSize > 0) {
+                            playerDetections = playerDetector.compareTiling(frame, tilingComparison);
+                        } else {
+                            playerDetections = playerDetector.detectTiled(frame);
+                        }
+                        frameDetectMs = std::chrono::duration<double, std::milli>(
+                            std::chrono::high_resolution_clock::now() - detectStart).count();
+                    }
+                    frameData.inputSize = playerDetector.getInputSize();
+                    detectMs += frameDetectMs;
+                    detectCalls++;
+                }
+                
+                if (runDetection) {
+                    // 分离球员和球（低分检测只保留球员，交给跟踪器）
+                    for (const auto& det : playerDetections) {
+                        if (det.classId == 0) { // 球员
+                            frameData.players.push_back(det);
+                        } else if (det.classId == 2 && det.confidence > config.playerConfThreshold) { // 球
+                            frameData.balls.push_back(det);
+                        }
+                    }
+                    
+                    // 跟踪球员，分配跨帧稳定的轨迹ID
+                    if (config.trackPlayers) {
+                        playerTracker.update(frameData.players, frame);
+                    }
+                } else {
+                    playerTracker.predictOnly(frameData.players, frame);
+                    if (config.evalDetectInterval) {
+                        predictionEval.accumulate(frameData.players, playerDetections,
+                                                  config.playerConfThreshold);
+                    }
+                }
+                
+                if (config.trackPlayers) {
+                    detectionScheduler.reportMotion(playerTracker.getStats().meanMotion);
+                    if (playerTracker.getStats().activeTracks == 0) {
+                        detectionScheduler.requestDetection();
+                    }
+                }
+                
+                // 整帧未检测到球时，在预测位置附近的原分辨率窗口上二次检测
+                if (config.ballRoi && !degraded && frameData.balls.empty() &&
+                    ballTracker.searchRegions(frame.size(), playerDetector.getInputSize(),
+                                              config.ballRoiCrops, ballRegions) > 0) {
+                    auto roiStart = std::chrono::high_resolution_clock::now();
+                    for (const auto& det : playerDetector.detectRegions(frame, ballRegions)) {
+                        if (det.classId == 2 && det.confidence > config.playerConfThreshold) {
+                            frameData.balls.push_back(det);
+                        }
+                    }
+                    ballRoiMs += std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - roiStart).count();
+                    ballRoiPasses++;
+                    ballRoiCropCount += static_cast<int>(ballRegions.size());
+                    if (!frameData.balls.empty()) {
+                        ballRoiHits++;
+                    }
+                }
+                
+                // 跟踪球（未检测到时输出预测位置）
+                frameData.ballState = ballTracker.update(frameData.balls, frameNumber);
+                
+                // 单应性（相机运动、关键点）与球队颜色互不依赖，作为一个任务与球队预测并行
+                TaskGroup geometry(taskScheduler.get());
+                geometry.run([&]() {
+                    // 通过帧间运动传播单应性矩阵
+                    if (config.trackHomography) {
+                        coordTransform.updateCameraMotion(frame, frameData.players, frameNumber);
+                    }
+                    
+                    // 检测球场关键点（启用运动跟踪时仅周期性或漂移时运行）
+                    if (!degraded && coordTransform.needsKeypointUpdate(frameNumber)) {
+                        if (item.keypointsDetected) {
+                            frameData.keypoints.swap(item.keypoints);
+                        } else {
+                            frameData.keypoints = keypointDetector.detect(frame);
+                        }
+                        
+                        // 计算单应性矩阵
+                        if (frameData.keypoints.size() >= 4) {
+                            coordTransform.computeHomography(frameData.keypoints, frameNumber);
+                        }
+                    }
+                });
+                
+                // 球队颜色自动标定（后台线程处理，标定完成前跳过球队预测）
+                if (teamCalibrator) {
+                    if (teamCalibrator->isCollecting()) {
+                        teamCalibrator->addFrame(frame, frameData.players);
+                    }
+                    if (teamCalibrator->isFinished()) {
+                        applyTeamCalibration();
+                    }
+                }
+                
+                // 球队预测
+                if (!degraded && !frameData.players.empty() && teamPredictor.getNumTeams() > 0) {
+                    teamPredictor.predictTeams(frame, frameData.players, frameData.teamIds);
+                }
+                
+                if (config.benchmarkPalette && !degraded && !frameData.players.empty() &&
+                    teamPredictor.getNumTeams() > 0) {
+                    paletteBenchmark.accumulate(
+                        teamPredictor.benchmarkPaletteModes(frame, frameData.players));
+                }
+                
+                geometry.wait();
             }
             
-            // 球队预测
-            if (!frameData.players.empty()) {
-                frameData.teamIds = teamPredictor.predictTeams(frame, frameData.players);
+            // 坐标转换（球员与球一次批量投影）
+            if (coordTransform.hasValidHomography() &&
+                (!frameData.players.empty() || !frameData.balls.empty())) {
+                coordTransform.projectDetections(frameData.players, frameData.balls, projection);
+                frameData.tacMapPositions.assign(projection.players(),
+                                                 projection.players() + projection.numPlayers);
+                frameData.ballTacMapPositions.assign(projection.balls(),
+                                                     projection.balls() + projection.numBalls);
             }
             
-            // 坐标转换
-            if (coordTransform.hasValidHomography() && !frameData.players.empty()) {
-                frameData.tacMapPositions = coordTransform.transformToTacticalMap(frameData.players);
+            if (coordTransform.hasValidHomography() && frameData.ballState.valid) {
+                cv::Point2f ballTacMap;
+                coordTransform.projectPoints(&frameData.ballState.position, &ballTacMap, 1);
+                ballTracker.setTacMapPosition(ballTacMap);
+                frameData.ballState = ballTracker.getState();
             }
             
-            // 发送数据到API
-            if (!apiClient.sendFrameData(frameData)) {
-                std::cerr << "Warning: Failed to send frame " << frameNumber << " data" << std::endl;
+            if (motionGate.isEnabled() && !reuseFrame) {
+                lastAnalysed = frameData;
+                lastTrackTeams.clear();
+                for (size_t i = 0; i < frameData.players.size() && i < frameData.teamIds.size(); i++) {
+                    if (frameData.players[i].trackId < 0) continue;
+                    lastTrackTeams.emplace_back(frameData.players[i].trackId, frameData.teamIds[i]);
+                }
+                std::sort(lastTrackTeams.begin(), lastTrackTeams.end());
             }
             
-            processedFrames++;
+            item.detectMs = frameDetectMs;
+            return true;
+        };
             
-            // 计算并显示进度
-            auto frameEndTime = std::chrono::high_resolution_clock::now();
-            auto frameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                frameEndTime - frameStartTime).count();
+        auto startTime = std::chrono::high_resolution_clock::now();
+        if (realtimeScheduler) {
+            realtimeScheduler->start();
+        }
+            
+        // 显示进度（预热结束时记录堆分配计数）
+        auto printProgress = [&](int frameNumber, long long frameDuration) {
+            if (processedFrames == kAllocationWarmupFrames) {
+                warmAllocations = AllocationCounter::getCount();
+            }
             
             if (frameNumber % 3 == 0 || frameNumber == videoReader.getTotalFrames()) {
                 float progress = (float)frameNumber / videoReader.getTotalFrames() * 100.0f;
                 auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    frameEndTime - startTime).count();
+                    std::chrono::high_resolution_clock::now() - startTime).count();
                 float fps = (float)processedFrames / elapsed;
                 
                 std::cout << "\rProgress: " << std::fixed << std::setprecision(1) << progress << "% "
@@ -232,6 +910,129 @@ int main(int argc, char** argv) {
                          << "| FPS: " << std::setprecision(2) << fps << " "
                          << "| Frame time: " << frameDuration << "ms    " << std::flush;
             }
+        };
+        
+        if (config.pipeline) {
+            // 检测不依赖上一帧分析结果时（每帧检测、无掩码/画面分类/运动门控/自适应分辨率），
+            // 由独立的检测阶段并行预取；否则仍在分析阶段中检测
+            bool prefetchDetection = config.detectInterval == 1 && !usePitchMask && !resolutionController &&
+                                     !config.sceneFilter && !motionGate.isEnabled() &&
+                                     !config.compareTiling && !config.evalDetectInterval;
+            // 未启用运动跟踪时每帧都需要关键点
+            bool prefetchKeypoints = prefetchDetection && !config.trackHomography;
+            
+            // 每个检测工作线程使用独立的检测器实例（检测器内部复用的缓冲区不能共享）
+            int detectWorkers = std::max(config.detectWorkers, 1);
+            std::vector<std::unique_ptr<YOLODetector>> workerPlayerDetectors;
+            std::vector<std::unique_ptr<YOLODetector>> workerKeypointDetectors;
+            for (int w = 0; prefetchDetection && w < detectWorkers; w++) {
+                workerPlayerDetectors.emplace_back(new YOLODetector(config.playerModelPath,
+                    config.trackPlayers ? kTrackerLowThreshold : config.playerConfThreshold));
+                workerPlayerDetectors.back()->setClassLabels(playerLabels);
+                workerPlayerDetectors.back()->setTiling(config.tileSize, config.tileOverlap);
+                workerPlayerDetectors.back()->setTaskScheduler(taskScheduler.get());
+                if (prefetchKeypoints) {
+                    workerKeypointDetectors.emplace_back(new YOLODetector(config.keypointModelPath,
+                                                                          config.keypointConfThreshold));
+                }
+            }
+            
+            PipelineExecutor pipeline(config.pipelineDepth);
+            if (prefetchDetection) {
+                pipeline.addStage("detect", [&](PipelineFrame& item, int worker) {
+                    auto detectStart = std::chrono::high_resolution_clock::now();
+                    item.detections = workerPlayerDetectors[worker]->detectTiled(item.frame);
+                    item.detectMs = std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - detectStart).count();
+                    item.detected = true;
+                    
+                    if (prefetchKeypoints) {
+                        item.keypoints = workerKeypointDetectors[worker]->detect(item.frame);
+                        item.keypointsDetected = true;
+                    }
+                }, detectWorkers);
+            } else {
+                std::cout << "Pipeline: detection depends on per-frame state, running it in the analyse stage" << std::endl;
+            }
+            pipeline.addStage("analyse", [&](PipelineFrame& item, int) {
+                auto analyseStart = std::chrono::high_resolution_clock::now();
+                bool analysed = analyseFrame(item, false);
+                
+                // 序列化与发送在其他阶段并行，帧耗时按分析阶段（含检测）计算
+                if (resolutionController && analysed) {
+                    resolutionController->report(item.detectMs, std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - analyseStart).count());
+                }
+            });
+            pipeline.addStage("serialize", [&](PipelineFrame& item, int) {
+                item.json = apiClient.serializeFrameData(item.data);
+            }, config.serializeWorkers);
+            
+            auto lastOutputTime = std::chrono::high_resolution_clock::now();
+            pipeline.run(
+                [&](PipelineFrame& item) {
+                    return videoReader.readFrame(item.frame);
+                },
+                [&](PipelineFrame& item) {
+                    // 发送数据到API（按帧序）
+                    if (asyncSender) {
+                        asyncSender->enqueue(std::move(item.json));
+                    } else if (!apiClient.sendSerializedFrame(item.json)) {
+                        std::cerr << "Warning: Failed to send frame " << item.data.frameNumber << " data" << std::endl;
+                    }
+                    processedFrames++;
+                    
+                    // 流水线模式下帧时间为相邻两帧的输出间隔
+                    auto outputTime = std::chrono::high_resolution_clock::now();
+                    auto frameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        outputTime - lastOutputTime).count();
+                    lastOutputTime = outputTime;
+                    printProgress(item.data.frameNumber, frameDuration);
+                });
+            pipelineStats = pipeline.getStats();
+        } else {
+            PipelineFrame current;   // 顺序模式下跨帧复用
+            int framesRead = 0;
+            while (videoReader.readFrame(current.frame)) {
+                framesRead++;
+                
+                FrameAction frameAction = realtimeScheduler ?
+                    realtimeScheduler->beginFrame(framesRead - 1) : FrameAction::Process;
+                if (frameAction == FrameAction::Drop) {
+                    continue;
+                }
+                
+                auto frameStartTime = std::chrono::high_resolution_clock::now();
+                
+                current.reset();
+                current.index = framesRead - 1;
+                bool analysed = analyseFrame(current, frameAction == FrameAction::Degrade);
+                
+                // 发送数据到API
+                if (asyncSender) {
+                    asyncSender->enqueue(apiClient.serializeFrameData(current.data));
+                } else if (!apiClient.sendFrameData(current.data)) {
+                    std::cerr << "Warning: Failed to send frame " << framesRead << " data" << std::endl;
+                }
+                
+                if (realtimeScheduler) {
+                    realtimeScheduler->endFrame();
+                }
+                
+                processedFrames++;
+                
+                // 计算并显示进度
+                auto frameEndTime = std::chrono::high_resolution_clock::now();
+                auto frameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    frameEndTime - frameStartTime).count();
+                
+                if (resolutionController && analysed) {
+                    resolutionController->report(current.detectMs, std::chrono::duration<double, std::milli>(
+                        frameEndTime - frameStartTime).count());
+                }
+                
+                printProgress(framesRead, frameDuration);
+            }
         }
         
         std::cout << std::endl;
@@ -239,12 +1040,22 @@ int main(int argc, char** argv) {
         // 7. 完成处理
         std::cout << "[7/7] Finalizing..." << std::endl;
         
+        // 视频在标定完成前结束：用已收集的样本完成标定并输出结果
+        if (teamCalibrator) {
+            teamCalibrator->finish();
+            applyTeamCalibration();
+        }
+        
         auto endTime = std::chrono::high_resolution_clock::now();
         auto totalDuration = std::chrono::duration_cast<std::chrono::seconds>(
             endTime - startTime).count();
         
-        // 通知视频处理完成
-        apiClient.notifyVideoComplete(config.videoPath);
+        // 通知视频处理完成（异步发送时先等待队列中的帧发送完成）
+        if (asyncSender) {
+            asyncSender->notifyVideoComplete(config.videoPath);
+        } else {
+            apiClient.notifyVideoComplete(config.videoPath);
+        }
         
         // 显示统计信息
         std::cout << std::endl;
@@ -255,6 +1066,219 @@ int main(int argc, char** argv) {
         std::cout << "Total time: " << totalDuration << " seconds" << std::endl;
         std::cout << "Average FPS: " << std::fixed << std::setprecision(2) 
                  << (float)processedFrames / totalDuration << std::endl;
+        
+        if (config.benchmarkPalette && paletteBenchmark.numCrops > 0) {
+            std::cout << "Palette benchmark (" << paletteBenchmark.numCrops << " crops): "
+                     << "team agreement " << std::setprecision(1)
+                     << 100.0 * paletteBenchmark.teamAgreements / paletteBenchmark.numCrops << "%, "
+                     << "hist " << std::setprecision(3)
+                     << paletteBenchmark.histogramMs / paletteBenchmark.numCrops << " ms/crop, "
+                     << "kmeans " << paletteBenchmark.kmeansMs / paletteBenchmark.numCrops << " ms/crop, "
+                     << "mean dominant color dLab "
+                     << paletteBenchmark.dominantLabDistance / paletteBenchmark.numCrops << std::endl;
+            std::cout << "Lab lookup table vs cvtColor: team agreement " << std::setprecision(1)
+                     << 100.0 * paletteBenchmark.lutAgreements / paletteBenchmark.numCrops << "%, "
+                     << "mean dominant color dLab " << std::setprecision(2)
+                     << paletteBenchmark.lutLabError / paletteBenchmark.numCrops << std::endl;
+        }
+        
+        const TrackerStats& trackerStats = playerTracker.getStats();
+        if (trackerStats.frames > 0) {
+            std::cout << "Player tracker: " << trackerStats.tracksCreated << " tracks, "
+                     << std::setprecision(3) << trackerStats.totalMs / trackerStats.frames
+                     << " ms/frame avg, " << trackerStats.maxMs << " ms max" << std::endl;
+        }
+        
+        if (config.detectInterval > 1) {
+            long long totalFrames = detectionScheduler.getDetectedFrames() +
+                                    detectionScheduler.getPredictedFrames();
+            std::cout << "Detect-every-N: " << detectionScheduler.getDetectedFrames() << "/"
+                     << totalFrames << " frames detected, "
+                     << detectionScheduler.getPredictedFrames() << " predicted "
+                     << "(predict " << std::setprecision(3)
+                     << (trackerStats.predictedFrames > 0
+                         ? trackerStats.predictMs / trackerStats.predictedFrames : 0.0)
+                     << " ms/frame)" << std::endl;
+            
+            if (detectCalls > 0 && totalFrames > 0) {
+                // 吞吐提升：每帧检测的耗时 / 隔帧检测 + 预测的耗时
+                double msPerDetect = detectMs / detectCalls;
+                double fullCost = msPerDetect * totalFrames;
+                double scheduledCost = msPerDetect * detectionScheduler.getDetectedFrames() +
+                                       trackerStats.predictMs;
+                std::cout << "Player detection throughput gain: " << std::setprecision(2)
+                         << fullCost / std::max(scheduledCost, 1e-6) << "x "
+                         << "(detector " << std::setprecision(3) << msPerDetect << " ms/call)" << std::endl;
+            }
+            
+            if (config.evalDetectInterval && predictionEval.detectedBoxes > 0) {
+                std::cout << "Predicted vs full detection (" << predictionEval.frames << " frames): "
+                         << "recall " << std::setprecision(1)
+                         << 100.0 * predictionEval.matchedBoxes / predictionEval.detectedBoxes << "%, "
+                         << "mean center error " << std::setprecision(2)
+                         << (predictionEval.matchedBoxes > 0
+                             ? predictionEval.centerErrorPx / predictionEval.matchedBoxes : 0.0) << " px, "
+                         << "mean IoU " << std::setprecision(3)
+                         << (predictionEval.matchedBoxes > 0
+                             ? predictionEval.iouSum / predictionEval.matchedBoxes : 0.0) << std::endl;
+            }
+        }
+        
+        if (tilingComparison.frames > 0) {
+            std::cout << "Tiled vs single-pass (" << tilingComparison.frames << " frames): "
+                     << tilingComparison.tiledDetections << " vs " << tilingComparison.singleDetections
+                     << " detections, single-pass recall by tiles " << std::setprecision(1)
+                     << (tilingComparison.singleDetections > 0
+                         ? 100.0 * tilingComparison.singleMatched / tilingComparison.singleDetections : 0.0)
+                     << "%, " << tilingComparison.tiledOnly << " found only by tiles, "
+                     << std::setprecision(3)
+                     << tilingComparison.tiledMs / tilingComparison.frames << " vs "
+                     << tilingComparison.singleMs / tilingComparison.frames << " ms/frame" << std::endl;
+        }
+        
+        if (ballRoiPasses > 0) {
+            std::cout << "Ball ROI re-detection: " << ballRoiHits << "/" << ballRoiPasses
+                     << " missed frames recovered (" << ballRoiCropCount << " crops, "
+                     << std::setprecision(3) << ballRoiMs / ballRoiPasses << " ms/pass)" << std::endl;
+        }
+        
+        if (config.sceneFilter) {
+            const SceneStats& sceneStats = sceneClassifier.getStats();
+            std::cout << "Scene filter: " << std::setprecision(1) << 100.0 * sceneStats.skippedRatio()
+                     << "% frames skipped (" << sceneStats.closeUpFrames << " close-up, "
+                     << sceneStats.nonPitchFrames << " non-pitch), " << sceneStats.cuts << " cuts, "
+                     << sceneResets << " tracking resets, " << std::setprecision(3)
+                     << (sceneStats.frames > 0 ? sceneStats.totalMs / sceneStats.frames : 0.0)
+                     << " ms/frame" << std::endl;
+        }
+        
+        if (resolutionController) {
+            const ResolutionStats& resolutionStats = resolutionController->getStats();
+            std::cout << "Adaptive input size (" << std::setprecision(1) << config.latencyBudgetMs
+                     << " ms budget): ";
+            for (size_t i = 0; i < resolutionStats.sizes.size(); i++) {
+                std::cout << (i > 0 ? ", " : "") << resolutionStats.sizes[i] << "px "
+                         << resolutionStats.frames[i] << " frames";
+            }
+            std::cout << "; " << resolutionStats.downgrades << " down / " << resolutionStats.upgrades
+                     << " up, " << resolutionStats.overBudgetFrames << " frames over budget" << std::endl;
+        }
+        
+        if (realtimeScheduler) {
+            const RealtimeStats& realtimeStats = realtimeScheduler->getStats();
+            std::cout << "Realtime (" << std::setprecision(1) << realtimeScheduler->getDeadlineMs()
+                     << " ms deadline): " << realtimeStats.processed << " full, " << realtimeStats.degraded
+                     << " degraded, " << realtimeStats.dropped << "/" << realtimeStats.frames << " dropped, "
+                     << realtimeStats.deadlineMisses << " deadline misses; latency p50 "
+                     << realtimeStats.latencyPercentile(50) << " / p95 " << realtimeStats.latencyPercentile(95)
+                     << " / p99 " << realtimeStats.latencyPercentile(99) << " ms" << std::endl;
+        }
+        
+        if (!pipelineStats.empty()) {
+            // 流水线吞吐受折算每帧耗时最大的阶段限制
+            size_t bottleneck = 0;
+            std::cout << "Pipeline stages (ms/frame): ";
+            for (size_t i = 0; i < pipelineStats.size(); i++) {
+                const StageStats& stage = pipelineStats[i];
+                std::cout << (i > 0 ? ", " : "") << stage.name;
+                if (stage.workers > 1) {
+                    std::cout << " x" << stage.workers;
+                }
+                std::cout << " " << std::setprecision(2) << stage.msPerFrame();
+                if (stage.msPerFrame() > pipelineStats[bottleneck].msPerFrame()) {
+                    bottleneck = i;
+                }
+            }
+            std::cout << "; bottleneck: " << pipelineStats[bottleneck].name << std::endl;
+        }
+        
+        if (asyncSender) {
+            const AsyncSendStats sendStats = asyncSender->getStats();
+            std::cout << "Async send: " << sendStats.sent << "/" << sendStats.enqueued << " frames sent in "
+                     << sendStats.requests << " requests, "
+                     << sendStats.failed << " failed, " << sendStats.dropped << " dropped, "
+                     << sendStats.spilled << " spilled, " << sendStats.retries << " retries; max queue depth "
+                     << sendStats.maxDepth << ", request " << std::setprecision(2)
+                     << (sendStats.requests > 0 ? sendStats.sendMs / sendStats.requests : 0.0) << " ms mean / "
+                     << sendStats.maxSendMs << " ms max, enqueue-to-sent "
+                     << (sendStats.sent > 0 ? sendStats.queueMs / sendStats.sent : 0.0) << " ms mean / "
+                     << sendStats.maxQueueMs << " ms max, frame loop blocked " << sendStats.blockedMs << " ms"
+                     << std::endl;
+        }
+        
+        const HttpStats httpStats = asyncSender ? asyncSender->getHttpStats() : apiClient.getHttpStats();
+        if (httpStats.requests > 0) {
+            std::cout << "HTTP: " << httpStats.requests << " requests over " << httpStats.connections
+                     << " connections (" << httpStats.reusedRequests() << " reused, " << httpStats.retries
+                     << " reconnects), " << httpStats.failures << " failed; latency " << std::setprecision(2)
+                     << httpStats.meanMs() << " ms mean / " << httpStats.maxMs << " ms max" << std::endl;
+        }
+        if (httpStats.frames > 0) {
+            // 帧数据的请求体字节数：批量减少每帧的请求开销，压缩减少传输量
+            std::cout << "Upload payload: " << httpStats.frames << " frames, " << std::setprecision(1)
+                     << httpStats.bodyBytes / 1024.0 << " KB JSON, " << httpStats.wireBytes / 1024.0
+                     << " KB sent (" << std::setprecision(0)
+                     << static_cast<double>(httpStats.wireBytes) / httpStats.frames << " B/frame, "
+                     << std::setprecision(2)
+                     << static_cast<double>(httpStats.frames) / std::max<long long>(httpStats.frameRequests, 1)
+                     << " frames/request)" << std::endl;
+        }
+        
+        if (taskScheduler) {
+            const TaskSchedulerStats schedulerStats = taskScheduler->getStats();
+            std::cout << "Task scheduler: " << schedulerStats.tasks << " tasks, " << std::setprecision(1)
+                     << (schedulerStats.tasks > 0 ? 100.0 * schedulerStats.stolen / schedulerStats.tasks : 0.0)
+                     << "% stolen" << std::endl;
+        }
+        
+        const FrameArenaStats arenaStats = FrameArena::getStats();
+        if (arenaStats.releases > 0) {
+            std::cout << "Frame arena: peak " << std::setprecision(1) << arenaStats.peakBytes / 1024.0
+                     << " KB/frame, buffer " << arenaStats.maxCapacity / 1024.0 << " KB, "
+                     << arenaStats.heapRefills << " heap refills" << std::endl;
+        }
+        if (AllocationCounter::isEnabled() && processedFrames > kAllocationWarmupFrames) {
+            std::cout << "Heap allocations: " << std::setprecision(1)
+                     << static_cast<double>(AllocationCounter::getCount() - warmAllocations) /
+                        (processedFrames - kAllocationWarmupFrames)
+                     << " per frame after " << kAllocationWarmupFrames << " warm-up frames" << std::endl;
+        }
+        
+        if (motionGate.isEnabled()) {
+            const MotionGateStats& gateStats = motionGate.getStats();
+            std::cout << "Motion gate: " << gateStats.reusedFrames << "/" << gateStats.frames
+                     << " frames reused (" << std::setprecision(1)
+                     << (gateStats.frames > 0 ? 100.0 * gateStats.reusedFrames / gateStats.frames : 0.0)
+                     << "%), fingerprint " << std::setprecision(3)
+                     << (gateStats.frames > 0 ? gateStats.totalMs / gateStats.frames : 0.0)
+                     << " ms/frame" << std::endl;
+        }
+        
+        if (usePitchMask) {
+            const PitchMaskStats& pitchMaskStats = pitchMask.getStats();
+            std::cout << "Pitch mask: " << playerDetector.getMaskRejected() << " off-pitch candidates dropped, "
+                     << teamPredictor.getCacheStats().offPitch << " players skipped for team colors, "
+                     << pitchMaskStats.updates << " updates (" << pitchMaskStats.outlineUpdates << " from outline, "
+                     << pitchMaskStats.invalidUpdates << " unusable), " << std::setprecision(3)
+                     << (pitchMaskStats.updates > 0 ? pitchMaskStats.totalMs / pitchMaskStats.updates : 0.0)
+                     << " ms/update" << std::endl;
+        }
+        
+        const TeamCacheStats& teamCacheStats = teamPredictor.getCacheStats();
+        if (teamCacheStats.lookups > 0) {
+            std::cout << "Team cache hit rate: " << std::setprecision(1)
+                     << 100.0 * teamCacheStats.hitRate() << "% "
+                     << "(" << teamCacheStats.hits << "/" << teamCacheStats.lookups << ")" << std::endl;
+        }
+        
+        const HomographyStats& homographyStats = coordTransform.getHomographyStats();
+        std::cout << "Homography updates: " << homographyStats.warmStartUpdates << " warm start, "
+                 << homographyStats.robustUpdates << " robust "
+                 << "(" << homographyStats.totalCalls << " calls, avg "
+                 << std::setprecision(3)
+                 << (homographyStats.totalCalls > 0
+                     ? homographyStats.totalComputeMs / homographyStats.totalCalls : 0.0)
+                 << " ms)" << std::endl;
         std::cout << "==================================================" << std::endl;
         
         return 0;